@@ -12,18 +12,26 @@
 #include "Game/Renderer.h"
 #include "Game/UI/RenderText.h"
 
+#include "Game/Dungeon/BackgroundGenerator.h"
 #include "Game/Dungeon/Dungeon.h"
+#include "Game/Dungeon/LevelCache.h"
+#include "Game/Dungeon/TileRenderData.h"
+#include "Game/Dungeon/TileRenderer.h"
 #include "Game/Physics/Entity.h"
+#include "Game/Physics/PlayerCollision.h"
 
 #include "Game/Utility/MeasureStatistics.h"
 
 #include <iostream>
+#include <optional>
 #include <string>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow* window);
+void processInput(GLFWwindow* window, BackgroundGenerator& generator);
+void editTile(Dungeon& dungeon, bool place);
 
 // settings
 const unsigned int SCR_WIDTH = 1920;
@@ -45,7 +53,6 @@ float lastFrame = 0.0f;
 float fps = 0.0f;
 float fpsLastFrame = 0.0f;
 
-bool generate = false;
 auto rightPressed = false;
 auto leftPressed = false;
 auto upPressed = false;
@@ -53,6 +60,12 @@ auto upPressed = false;
 auto F1Pressed = false;
 auto spacePressed = false;
 
+// left mouse button breaks the block that the camera looks at, right mouse button places a block in front of it
+auto breakBlock = false;
+auto placeBlock = false;
+auto leftMousePressed = false;
+auto rightMousePressed = false;
+
 SeedType seed = 0;
 
 auto disableCollision = false;
@@ -71,6 +84,54 @@ int main() {
         seed = RNG(SeedType()).RandomSeed();
     }
 
+    if (Assets::HasConfigParameter("counter-rng") && Assets::GetConfigParameter<bool>("counter-rng")) {
+        dungeon.SetRNGMode(RNGMode::Counter);
+    }
+    if (Assets::HasConfigParameter("room-placement") && Assets::GetConfigParameter<std::string>("room-placement") == "free-space") {
+        dungeon.SetRoomPlacement(RoomPlacement::FreeSpace);
+    }
+    if (Assets::HasConfigParameter("canon-check")) {
+        auto canonCheck = Assets::GetConfigParameter<std::string>("canon-check");
+        if (canonCheck == "none") {
+            dungeon.SetCanonCheck(CanonCheck::None);
+        } else if (canonCheck == "diff") {
+            dungeon.SetCanonCheck(CanonCheck::FullDiff);
+        } else if (canonCheck == "record") {
+            dungeon.SetCanonCheck(CanonCheck::Record);
+        }
+    }
+    if (Assets::HasConfigParameter("starting-room")) {
+        dungeon.SetStartingRoom(Assets::GetConfigParameter<size_t>("starting-room"));
+    }
+
+    // generated levels are cached on disk, size limit of the cache is set in megabytes (0 disables the cache)
+    auto levelCacheSize = std::uintmax_t(256);
+    if (Assets::HasConfigParameter("level-cache-size")) {
+        levelCacheSize = Assets::GetConfigParameter<std::uintmax_t>("level-cache-size");
+    }
+    auto levelCache = LevelCache("cache", levelCacheSize * 1024 * 1024);
+    if (levelCacheSize > 0) {
+        dungeon.SetLevelCache(&levelCache);
+    }
+
+    // instance data is cached together with the level
+    auto buildRenderData = [&](const Dungeon& level) {
+        if (levelCacheSize == 0) {
+            return BuildTileRenderData(level.GetTiles(), level.GetRegions());
+        }
+
+        auto data = levelCache.LoadRenderData(level.GetLevelKey());
+        if (!data.has_value()) {
+            data = BuildTileRenderData(level.GetTiles(), level.GetRegions());
+            levelCache.StoreRenderData(level.GetLevelKey(), data.value());
+        }
+        return data.value();
+    };
+
+    // next levels are generated in background (into a copy of the configured dungeon),
+    // only the first one is generated before the window is created
+    auto generator = BackgroundGenerator(dungeon, buildRenderData);
+
     dungeon.SetSeed(seed);
     dungeon.Generate();
 
@@ -123,7 +184,9 @@ int main() {
 
     Assets::Get().orthogonalProjection = glm::ortho(0.0f, static_cast<float>(SCR_WIDTH), 0.0f, static_cast<float>(SCR_HEIGHT));
 
-    dungeon.InitInstancedRendering();
+    auto tileRenderer = TileRenderer();
+    tileRenderer.InitInstancedRendering(buildRenderData(dungeon));
+    tileRenderer.InitPortalCulling(dungeon.GetPortals(), dungeon.GetRegionCount());
 
     player.SetFlying(true);
     player.SetPosition(glm::vec3(dungeon.GetSpawnPoint()));
@@ -146,11 +209,37 @@ int main() {
             fpsLastFrame = currentFrame;
         }
 
-        processInput(window);
+        processInput(window, generator);
+
+        // generated level is swapped in between frames, the player starts at its spawn point
+        auto data = TileRenderData();
+        if (generator.TrySwap(dungeon, data)) {
+            tileRenderer.InitInstancedRendering(data);
+            tileRenderer.InitPortalCulling(dungeon.GetPortals(), dungeon.GetRegionCount());
+            player.SetPosition(glm::vec3(dungeon.GetSpawnPoint()));
+            camera.Position = player.GetPosition() + glm::vec3(0.0f, 0.1f, 0.0f);
+        }
 
         player.Update(dungeon.GetTiles(), deltaTime, disableCollision);
         camera.Position = player.GetPosition() + glm::vec3(0.0f, 0.1f, 0.0f);
 
+        if (breakBlock || placeBlock) {
+            editTile(dungeon, placeBlock);
+            breakBlock = false;
+            placeBlock = false;
+        }
+        // only the chunks changed by the edits are rebuilt
+        auto dirtyChunks = std::vector<size_t>();
+        for (const auto& coords : dungeon.TakeEditedTiles()) {
+            AddChunksOfTile(dungeon.GetTiles(), coords, dirtyChunks);
+        }
+        for (auto index : dirtyChunks) {
+            tileRenderer.UpdateChunk(index, BuildChunkRenderData(dungeon.GetTiles(), dungeon.GetRegions(), index));
+        }
+        if (!dirtyChunks.empty()) {
+            tileRenderer.InitPortalCulling(dungeon.GetPortals(), dungeon.GetRegionCount());
+        }
+
         glClearColor(0.7f, 0.7f, 0.7f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -159,20 +248,15 @@ int main() {
         Assets::Get().projection = projection;
         Assets::Get().view = view;
 
-        if (generate) {
-            generate = false;
-            dungeon.SetSeed(seed);
-            dungeon.Generate();
-            dungeon.InitInstancedRendering();
-            player.SetPosition(glm::vec3(dungeon.GetSpawnPoint()));
-            camera.Position = player.GetPosition();
-
-            // print statistics report
-            util::PrintReport();
-            util::Reset();
+        // portals are walked from the region of the camera, unless the camera is inside of a block,
+        // coarse levels of detail are used only when the camera is outside of the level
+        auto cameraCoords = FromVec3(camera.Position);
+        auto cameraOutside = !dungeon.GetTiles().IsInBoundsOrBorder(cameraCoords);
+        auto cameraRegion = std::optional<RegionId>();
+        if (cameraOutside || !IsSolidBlock(dungeon.GetTiles().Get(cameraCoords).type)) {
+            cameraRegion = dungeon.GetPortalCell(cameraCoords);
         }
-
-        dungeon.Render();
+        tileRenderer.RenderTilesInstanced(cameraRegion, cameraOutside);
 
         // render text
         auto fpsstr = std::to_string(static_cast<int>(glm::round(fps)));
@@ -192,12 +276,24 @@ int main() {
         auto dc = std::to_string(disableCollision);
         auto fl = std::to_string(player.IsFlying());
         auto gr = std::to_string(player.IsGrounded());
-        auto room = std::to_string(dungeon.WhichRoomPointIsInside(FromVec3(pos)));
+        auto region = dungeon.GetRegion(FromVec3(pos));
+        auto room = region.type == Region::Type::None       ? std::string("-")
+                    : region.type == Region::Type::Corridor ? "corridor " + std::to_string(region.index)
+                                                            : std::to_string(region.index);
+        const auto& renderStats = tileRenderer.GetStats();
+        auto chunks = std::to_string(renderStats.chunksDrawn) + "/" + std::to_string(renderStats.chunksDrawn + renderStats.chunksCulled) + " (" +
+                      std::to_string(renderStats.chunksCoarse) + " coarse)";
+        auto regions = std::to_string(renderStats.regionsVisible) + "/" + std::to_string(renderStats.regionCount);
 
         glDisable(GL_DEPTH_TEST);
         textRenderer.RenderText("fps: " + fpsstr + " pos: " + posx + " " + posy + " " + posz + " vel: " + velx + " " + vely + " " + velz +
-                                    " dc: " + dc + " fl: " + fl + " gr: " + gr + " room: " + room,
+                                    " dc: " + dc + " fl: " + fl + " gr: " + gr + " room: " + room + " chunks: " + chunks + " regions: " + regions,
                                 glm::vec2(25.0f, 25.0f), 1.0f, glm::vec3(0.5, 0.8f, 0.2f));
+        if (generator.IsBusy()) {
+            auto progress = std::to_string(static_cast<int>(generator.GetProgress() * 100.0f));
+            textRenderer.RenderText("generating level " + std::to_string(generator.GetSeed()) + ": " + progress + "%", glm::vec2(25.0f, 75.0f), 1.0f,
+                                    glm::vec3(0.5, 0.8f, 0.2f));
+        }
         glEnable(GL_DEPTH_TEST);
 
         glfwSwapBuffers(window);
@@ -210,12 +306,12 @@ int main() {
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow* window) {
+void processInput(GLFWwindow* window, BackgroundGenerator& generator) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
 
     if (!rightPressed && glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
         ++seed;
-        generate = true;
+        generator.Request(seed);
         rightPressed = true;
     }
     if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_RELEASE) {
@@ -224,7 +320,7 @@ void processInput(GLFWwindow* window) {
 
     if (!leftPressed && glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
         --seed;
-        generate = true;
+        generator.Request(seed);
         leftPressed = true;
     }
     if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_RELEASE) {
@@ -232,7 +328,7 @@ void processInput(GLFWwindow* window) {
     }
 
     if (!upPressed && glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-        generate = true;
+        generator.Request(seed);
         upPressed = true;
     }
     if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_RELEASE) {
@@ -269,6 +365,18 @@ void processInput(GLFWwindow* window) {
         F1Pressed = false;
     }
 
+    auto leftMouse = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    if (leftMouse && !leftMousePressed) {
+        breakBlock = true;
+    }
+    leftMousePressed = leftMouse;
+
+    auto rightMouse = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+    if (rightMouse && !rightMousePressed) {
+        placeBlock = true;
+    }
+    rightMousePressed = rightMouse;
+
     if (!player.IsFlying() && jump) {
         player.Jump();
     }
@@ -282,6 +390,43 @@ void processInput(GLFWwindow* window) {
     }
 }
 
+// breaks the block that the camera looks at, or places a block of the same color in front of it
+// -----------------------------------------------------------------------------------------------
+void editTile(Dungeon& dungeon, bool place) {
+    static constexpr auto reach = 5.0f;
+
+    const auto& tiles = dungeon.GetTiles();
+    auto hit = RayCast(Ray{camera.Position, camera.Front}, tiles, reach);
+    if (!hit.has_value() || hit->t > reach) {
+        return;
+    }
+
+    auto normal = glm::dot(hit->surfaceNormal, camera.Front) > 0.0f ? -hit->surfaceNormal : hit->surfaceNormal;
+    auto block = FromVec3(hit->intersectionPoint - 0.5f * normal);
+    if (!IsInBounds(block, tiles.GetDimensions()) || !IsSolidBlock(tiles.Get(block).type)) {
+        return;
+    }
+
+    if (!place) {
+        dungeon.SetTile(block, Tile{TileType::Air});
+        return;
+    }
+
+    auto coords = FromVec3(hit->intersectionPoint + 0.5f * normal);
+    auto type = IsInBounds(coords, tiles.GetDimensions()) ? tiles.Get(coords).type : TileType::Void;
+    // blocks are not placed into stairs, out of the level, or onto the player
+    if (IsSolidBlock(type) || IsStairs(type) || type == TileType::Void) {
+        return;
+    }
+    if (coords == FromVec3(player.GetPosition()) || coords == FromVec3(camera.Position)) {
+        return;
+    }
+
+    auto tile = tiles.Get(block);
+    tile.type = TileType::Block;
+    dungeon.SetTile(coords, tile);
+}
+
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
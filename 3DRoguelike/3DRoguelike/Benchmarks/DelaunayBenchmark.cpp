@@ -0,0 +1,250 @@
+// Validation and benchmark of the Delaunay triangulation and MST of room centers.
+// Results are compared with CGAL (triangulation) and boost (Kruskal MST) on random inputs, including degenerate ones
+// (points on a grid, coplanar and cospherical points), then both implementations are timed on growing inputs (including coplanar ones).
+//
+// Usage: delaunay_benchmark [max number of points]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/kruskal_min_spanning_tree.hpp>
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Delaunay_triangulation_3.h>
+#include <CGAL/Delaunay_triangulation_cell_base_3.h>
+#include <CGAL/Triangulation_vertex_base_with_info_3.h>
+
+#include "../Game/Assert.h"
+#include "../Game/Algorithms/Delaunay3D.h"
+#include "../Game/Algorithms/MST.h"
+#include "../Game/Utility/Random.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+namespace reference {
+
+using K = CGAL::Exact_predicates_inexact_constructions_kernel;
+using Vb = CGAL::Triangulation_vertex_base_with_info_3<size_t, K>;
+using Cb = CGAL::Delaunay_triangulation_cell_base_3<K>;
+using Tds = CGAL::Triangulation_data_structure_3<Vb, Cb>;
+using Delaunay = CGAL::Delaunay_triangulation_3<K, Tds, CGAL::Fast_location>;
+using Point = Delaunay::Point;
+
+// previous implementation of Delaunay3D
+std::vector<Edge> Delaunay3D(const std::vector<glm::vec3>& pointsVec) {
+    auto points = std::vector<std::pair<Point, size_t>>();
+    for (size_t i = 0; i < pointsVec.size(); ++i) {
+        const auto& point = pointsVec[i];
+        points.push_back(std::make_pair(Point(point.x, point.y, point.z), i));
+    }
+
+    auto T = Delaunay(points.begin(), points.end());
+    LOG_ASSERT(T.number_of_vertices() == pointsVec.size());
+
+    auto edges = std::vector<Edge>();
+    for (const auto& e : T.finite_edges()) {
+        const auto v1 = e.first->vertex(e.second)->info();
+        const auto v2 = e.first->vertex(e.third)->info();
+
+        edges.push_back({std::min(v1, v2), std::max(v1, v2)});
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    return edges;
+}
+
+using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, boost::no_property, boost::property<boost::edge_weight_t, Weight>>;
+
+// previous implementation of MinimumSpanningTree
+std::vector<Edge> MinimumSpanningTree(const std::vector<Edge>& graph, size_t vertices, const std::vector<Weight>& weights) {
+    auto edgeVec = std::vector<std::pair<size_t, size_t>>();
+    for (const auto& edge : graph) {
+        edgeVec.push_back({edge.v1, edge.v2});
+    }
+    auto g = Graph(edgeVec.begin(), edgeVec.end(), weights.begin(), vertices);
+
+    auto spanningTree = std::vector<boost::graph_traits<Graph>::edge_descriptor>();
+    boost::kruskal_minimum_spanning_tree(g, std::back_inserter(spanningTree));
+
+    auto edges = std::vector<Edge>();
+    for (const auto& edge : spanningTree) {
+        edges.push_back(Edge{boost::source(edge, g), boost::target(edge, g)});
+    }
+    return edges;
+}
+
+}  // namespace reference
+
+enum class Distribution { Uniform, Grid, RoomCenters, Plane, TiltedPlane, Sphere };
+
+// distinct random points
+std::vector<glm::vec3> randomPoints(RNG& rng, size_t count, Distribution distribution) {
+    auto points = std::vector<glm::vec3>();
+    auto used = std::set<std::tuple<float, float, float>>();
+
+    // grid inputs are limited by the number of grid cells
+    for (size_t attempt = 0; points.size() < count && attempt < 100 * count; ++attempt) {
+        auto point = glm::vec3();
+        switch (distribution) {
+            case Distribution::Uniform:
+                point = glm::vec3(rng.RealUniform(-100.0f, 100.0f), rng.RealUniform(-100.0f, 100.0f), rng.RealUniform(-100.0f, 100.0f));
+                break;
+            case Distribution::Grid:
+                point = glm::vec3(rng.IntUniform(0, 4), rng.IntUniform(0, 4), rng.IntUniform(0, 4));
+                break;
+            case Distribution::RoomCenters:
+                // rooms have integer positions and sizes, so their centers are on the grid with step 0.5
+                point = glm::vec3(rng.IntUniform(0, 120), rng.IntUniform(0, 12), rng.IntUniform(0, 120)) * 0.5f;
+                break;
+            case Distribution::Plane:
+                point = glm::vec3(rng.IntUniform(0, 10), 5.0f, rng.IntUniform(0, 10));
+                break;
+            case Distribution::TiltedPlane: {
+                // plane that is not parallel to the axes, grid points on it are often collinear and cocircular
+                auto x = rng.IntUniform(0, 20);
+                auto z = rng.IntUniform(0, 20);
+                point = glm::vec3(x, x + 2 * z, z);
+                break;
+            }
+            case Distribution::Sphere:
+                // integer points on the sphere with radius 5 and a few points inside
+                point = glm::vec3(rng.IntUniform(-5, 5), rng.IntUniform(-5, 5), rng.IntUniform(-5, 5));
+                if (glm::length2(point) != 25.0f && rng.RandomBool(0.9f)) {
+                    continue;
+                }
+                break;
+        }
+
+        if (used.insert({point.x, point.y, point.z}).second) {
+            points.push_back(point);
+        }
+    }
+
+    return points;
+}
+
+std::vector<Weight> edgeWeights(const std::vector<glm::vec3>& points, const std::vector<Edge>& edges) {
+    auto weights = std::vector<Weight>();
+    for (const auto& edge : edges) {
+        auto diff = points[edge.v1] - points[edge.v2];
+        diff.y *= 10.0f;
+        weights.push_back(Weight(glm::length2(diff)));
+    }
+    return weights;
+}
+
+// compares results with the reference implementations, returns number of mismatches
+int validate(size_t inputs) {
+    auto rng = RNG(SeedType(0));
+    auto mismatches = 0;
+
+    for (size_t i = 0; i < inputs; ++i) {
+        auto distribution = static_cast<Distribution>(i % 6);
+        auto points = randomPoints(rng, rng.IntUniform<size_t>(1, 300), distribution);
+
+        auto edges = Delaunay3D(points);
+        if (edges != reference::Delaunay3D(points)) {
+            std::cout << "triangulation mismatch: input " << i << ", " << points.size() << " points\n";
+            ++mismatches;
+            continue;
+        }
+
+        auto weights = edgeWeights(points, edges);
+        if (MinimumSpanningTree(edges, points.size(), weights) != reference::MinimumSpanningTree(edges, points.size(), weights)) {
+            std::cout << "MST mismatch: input " << i << ", " << points.size() << " points\n";
+            ++mismatches;
+        }
+    }
+
+    return mismatches;
+}
+
+void benchmark(size_t count) {
+    auto rng = RNG(SeedType(count));
+    for (auto distribution : {Distribution::Uniform, Distribution::RoomCenters, Distribution::Plane}) {
+        auto points = std::vector<glm::vec3>();
+        if (distribution == Distribution::Uniform) {
+            points = randomPoints(rng, count, distribution);
+        } else if (distribution == Distribution::Plane) {
+            // room centers on one floor (rooms of the same height), triangulation falls back to 2D
+            auto size = static_cast<int>(std::sqrt(static_cast<double>(count)) * 2.0);
+            auto used = std::set<std::pair<int, int>>();
+            while (points.size() < count) {
+                auto center = std::make_pair(rng.IntUniform(0, 2 * size), rng.IntUniform(0, 2 * size));
+                if (used.insert(center).second) {
+                    points.push_back(glm::vec3(center.first, 4.0f, center.second) * 0.5f);
+                }
+            }
+        } else {
+            // room centers spread over the level that grows with the number of rooms
+            auto size = static_cast<int>(std::cbrt(static_cast<double>(count)) * 8.0);
+            auto used = std::set<std::tuple<int, int, int>>();
+            while (points.size() < count) {
+                auto center = std::make_tuple(rng.IntUniform(0, 2 * size), rng.IntUniform(0, size / 2), rng.IntUniform(0, 2 * size));
+                if (used.insert(center).second) {
+                    points.push_back(glm::vec3(std::get<0>(center), std::get<1>(center), std::get<2>(center)) * 0.5f);
+                }
+            }
+        }
+
+        auto start = Clock::now();
+        auto edges = Delaunay3D(points);
+        auto delaunay = millisecondsSince(start);
+
+        start = Clock::now();
+        auto referenceEdges = reference::Delaunay3D(points);
+        auto referenceDelaunay = millisecondsSince(start);
+        LOG_ASSERT(edges == referenceEdges);
+
+        auto weights = edgeWeights(points, edges);
+
+        start = Clock::now();
+        auto tree = MinimumSpanningTree(edges, points.size(), weights);
+        auto mst = millisecondsSince(start);
+
+        start = Clock::now();
+        auto referenceTree = reference::MinimumSpanningTree(edges, points.size(), weights);
+        auto referenceMst = millisecondsSince(start);
+        LOG_ASSERT(tree == referenceTree);
+
+        auto name = distribution == Distribution::Uniform ? "uniform"
+                    : distribution == Distribution::Plane ? "coplanar room centers"
+                                                          : "room centers";
+        std::cout << name << ", " << count << " points, " << edges.size() << " edges: delaunay " << delaunay << " ms (CGAL " << referenceDelaunay
+                  << " ms), mst " << mst << " ms (boost " << referenceMst << " ms)\n";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto maxPoints = argc > 1 ? std::stoul(argv[1]) : 100000ul;
+
+    auto mismatches = validate(500);
+    std::cout << "validation: " << mismatches << " mismatches\n";
+
+    for (auto count = size_t(100); count <= maxPoints; count *= 10) {
+        benchmark(count);
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Benchmark of the world grid memory layout (see TilesLayout in WorldGrid.h).
+// Executable is built once for every layout, compare the output of layout_benchmark_* targets.
+//
+// Usage: layout_benchmark_<layout> [number of seeds]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <glm/glm.hpp>
+
+#include "../Game/Assert.h"
+#include "../Game/Dungeon/Dungeon.h"
+#include "../Game/Dungeon/TileRenderData.h"
+#include "../Game/Physics/Entity.h"
+#include "../Game/Utility/MeasureStatistics.h"
+#include "../Game/Utility/Random.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// moves entities around the spawn point, returns number of entity updates per second
+double measureCollision(const TilesVec& tiles, const glm::ivec3& spawn, RNG& rng) {
+    static constexpr auto entities = 50;
+    static constexpr auto steps = 20;
+    static constexpr auto deltaTime = 1.0f / 60.0f;
+    static constexpr auto speed = 3.0f;
+
+    auto start = Clock::now();
+
+    for (int i = 0; i < entities; ++i) {
+        auto entity = Entity();
+        entity.SetFlying(rng.RandomBool());
+        entity.SetPosition(glm::vec3(spawn) + glm::vec3(rng.RealUniform(-2.0f, 2.0f), 0.0f, rng.RealUniform(-2.0f, 2.0f)));
+
+        for (int j = 0; j < steps; ++j) {
+            entity.GetAcceleration() = speed * glm::vec3(rng.RealUniform(-1.0f, 1.0f), 0.0f, rng.RealUniform(-1.0f, 1.0f));
+            entity.Update(tiles, deltaTime, false);
+        }
+    }
+
+    return entities * steps / secondsSince(start);
+}
+
+// builds render data for the whole level on the threads (0 - all hardware threads), returns number of processed voxels per second
+double measureMeshing(const TilesVec& tiles, const RegionsVec& regions, size_t threads) {
+    static constexpr auto repeats = 20;
+
+    auto start = Clock::now();
+
+    auto vertices = size_t(0);
+    for (int i = 0; i < repeats; ++i) {
+        for (const auto& chunk : BuildTileRenderData(tiles, regions, threads).chunks) {
+            vertices += chunk.blocks.size();
+        }
+    }
+
+    auto seconds = secondsSince(start);
+    LOG_ASSERT(vertices > 0);
+
+    return repeats * Volume(tiles.GetDimensions()) / seconds;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto seeds = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    auto dungeon = Dungeon(Dimensions{50, 20, 50});
+    dungeon.SetCanonCheck(CanonCheck::None);
+    dungeon.SetVerbose(false);
+    auto rng = RNG(SeedType(0));
+
+    auto collision = 0.0;
+    auto meshing = 0.0;
+    auto parallelMeshing = 0.0;
+
+    util::Reset();
+    for (int seed = 0; seed < seeds; ++seed) {
+        dungeon.SetSeed(SeedType(seed));
+        dungeon.Generate();
+
+        collision += measureCollision(dungeon.GetTiles(), dungeon.GetSpawnPoint(), rng);
+        meshing += measureMeshing(dungeon.GetTiles(), dungeon.GetRegions(), 1);
+        parallelMeshing += measureMeshing(dungeon.GetTiles(), dungeon.GetRegions(), 0);
+    }
+
+    const auto& s = util::GetStatistics();
+    auto pathfinding = s.findPathCount / (static_cast<double>(s.findPathTotalTime) / 1e6);
+
+    std::cout << "layout: " << TilesLayout::name << "\n";
+    std::cout << "pathfinding: " << pathfinding << " paths/s\n";
+    std::cout << "collision: " << collision / seeds << " entity updates/s\n";
+    std::cout << "meshing: " << meshing / seeds / 1e6 << " Mvoxels/s\n";
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "meshing on " << threads << " threads: " << parallelMeshing / seeds / 1e6 << " Mvoxels/s\n";
+
+    return 0;
+}
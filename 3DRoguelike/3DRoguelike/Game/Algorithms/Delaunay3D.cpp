@@ -1,50 +1,782 @@
 #include "Delaunay3D.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <utility>
 #include <tuple>
 
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Delaunay_triangulation_3.h>
-#include <CGAL/Delaunay_triangulation_cell_base_3.h>
-#include <CGAL/Triangulation_vertex_base_with_info_3.h>
-
+#include "ExactPredicates.h"
 #include "../Assert.h"
 
-using K = CGAL::Exact_predicates_inexact_constructions_kernel;
-using Vb = CGAL::Triangulation_vertex_base_with_info_3<size_t, K>;
-using Cb = CGAL::Delaunay_triangulation_cell_base_3<K>;
-using Tds = CGAL::Triangulation_data_structure_3<Vb, Cb>;
-// Use the Fast_location tag. Default or Compact_location works too.
-using Delaunay = CGAL::Delaunay_triangulation_3<K, Tds, CGAL::Fast_location>;
-using Point = Delaunay::Point;
+using predicates::Point;
 
-std::vector<Edge> Delaunay3D(const std::vector<glm::vec3>& pointsVec) {
-    auto points = std::vector<std::pair<Point, size_t>>();
-    for (size_t i = 0; i < pointsVec.size(); ++i) {
-        const auto& point = pointsVec[i];
-        points.push_back(std::make_pair(Point(point.x, point.y, point.z), i));
+namespace {
+
+using VertexIndex = std::uint32_t;
+using CellIndex = std::uint32_t;
+
+// vertex at infinity, every face of the convex hull is connected to it by an infinite cell
+static constexpr VertexIndex infinite = std::numeric_limits<VertexIndex>::max();
+static constexpr CellIndex noCell = std::numeric_limits<CellIndex>::max();
+
+// tetrahedron, finite cells are positively oriented,
+// infinite cells are oriented as if the infinite vertex was a point on the outer side of their hull face
+struct Cell {
+    std::array<VertexIndex, 4> vertices;
+    // neighbors[i] shares the face opposite to vertices[i]
+    std::array<CellIndex, 4> neighbors;
+    // generation of the last conflict test (odd - in conflict, even - not in conflict)
+    std::uint32_t mark = 0;
+    bool alive = true;
+};
+
+// symbolic perturbation of degenerate cases (same as in CGAL), so that the triangulation is unique even for cospherical points:
+// points are perturbed by amounts that decrease in lexicographic order of the points
+struct PerturbationOrder {
+    const std::vector<Point>* points;
+
+    bool operator()(VertexIndex a, VertexIndex b) const {
+        return predicates::LexicographicallyLess((*points)[a], (*points)[b]);
+    }
+};
+
+// for coplanar a, b, c, p and a point d that is not in their plane: true if p is inside of the circumcircle of abc (with perturbation)
+bool inCircle(const std::vector<Point>& points, std::array<VertexIndex, 3> triangle, VertexIndex p, VertexIndex d) {
+    const auto& [a, b, c] = triangle;
+    auto side = predicates::CoplanarSideOfBoundedCircle(points[a], points[b], points[c], points[p]);
+    if (side != 0) {
+        return side > 0;
+    }
+
+    auto local = predicates::Orientation(points[a], points[b], points[c], points[d]);
+
+    auto sorted = std::array{a, b, c, p};
+    std::sort(sorted.begin(), sorted.end(), PerturbationOrder{&points});
+    for (size_t i = 3; i > 0; --i) {
+        if (sorted[i] == p) {
+            return false;
+        }
+
+        auto replaced = triangle;
+        *std::find(replaced.begin(), replaced.end(), sorted[i]) = p;
+        auto orientation = predicates::Orientation(points[replaced[0]], points[replaced[1]], points[replaced[2]], points[d]);
+        if (orientation != 0) {
+            return orientation * local > 0;
+        }
+    }
+
+    LOG_ASSERT(false && "degenerate perturbation");
+    return false;
+}
+
+// incremental (Bowyer-Watson) Delaunay triangulation
+class Triangulation {
+ public:
+    explicit Triangulation(const std::vector<Point>& points_) : points(points_) {
+    }
+
+    // inserts points in their order, returns false if all points are coplanar
+    bool Build() {
+        // find 4 points that are not coplanar
+        auto first = std::array<VertexIndex, 4>();
+        auto found = size_t(0);
+        for (VertexIndex vertex = 0; vertex < points.size() && found < 4; ++vertex) {
+            if (found < 2 || (found == 2 && !predicates::Collinear(points[first[0]], points[first[1]], points[vertex])) ||
+                (found == 3 && predicates::Orientation(points[first[0]], points[first[1]], points[first[2]], points[vertex]) != 0)) {
+                first[found++] = vertex;
+            }
+        }
+        if (found < 4) {
+            return false;
+        }
+
+        // there are about 6.7 cells per vertex
+        cells.reserve(7 * points.size());
+        initialize(first);
+
+        auto start = CellIndex(0);
+        for (VertexIndex vertex = 0; vertex < points.size(); ++vertex) {
+            if (std::find(first.begin(), first.end(), vertex) == first.end()) {
+                start = insert(vertex, start);
+            }
+        }
+
+        return true;
+    }
+
+    // original[v] is the index of the vertex v in the input
+    std::vector<Edge> GetEdges(const std::vector<VertexIndex>& original) const {
+        auto forEachEdge = [&](auto&& function) {
+            for (const auto& cell : cells) {
+                if (!cell.alive) {
+                    continue;
+                }
+
+                for (size_t i = 0; i < 4; ++i) {
+                    for (size_t j = i + 1; j < 4; ++j) {
+                        if (cell.vertices[i] != infinite && cell.vertices[j] != infinite) {
+                            auto v1 = original[cell.vertices[i]];
+                            auto v2 = original[cell.vertices[j]];
+                            function(std::min(v1, v2), std::max(v1, v2));
+                        }
+                    }
+                }
+            }
+        };
+
+        // edges are grouped by the first vertex (counting sort), then every group is sorted separately
+        auto offsets = std::vector<size_t>(points.size() + 1, 0);
+        forEachEdge([&](VertexIndex v1, VertexIndex) { ++offsets[v1 + 1]; });
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+
+        auto seconds = std::vector<VertexIndex>(offsets.back());
+        auto positions = offsets;
+        forEachEdge([&](VertexIndex v1, VertexIndex v2) { seconds[positions[v1]++] = v2; });
+
+        auto edges = std::vector<Edge>();
+        for (size_t v1 = 0; v1 < points.size(); ++v1) {
+            auto begin = seconds.begin() + static_cast<std::ptrdiff_t>(offsets[v1]);
+            auto end = seconds.begin() + static_cast<std::ptrdiff_t>(offsets[v1 + 1]);
+            std::sort(begin, end);
+            end = std::unique(begin, end);
+            for (auto it = begin; it != end; ++it) {
+                edges.push_back({v1, *it});
+            }
+        }
+        return edges;
+    }
+
+ private:
+    struct Face {
+        std::array<VertexIndex, 3> vertices;
+        CellIndex cell;
+        size_t index;
+    };
+
+    void initialize(std::array<VertexIndex, 4> vertices) {
+        if (orientation(vertices) < 0) {
+            std::swap(vertices[0], vertices[1]);
+        }
+
+        cells.push_back({vertices, {1, 2, 3, 4}});
+        for (size_t i = 0; i < 4; ++i) {
+            auto infiniteCell = Cell{vertices, {noCell, noCell, noCell, noCell}};
+            infiniteCell.vertices[i] = infinite;
+            infiniteCell.neighbors[i] = 0;
+            // flip orientation by swapping two other vertices
+            auto a = (i + 1) % 4;
+            auto b = (i + 2) % 4;
+            std::swap(infiniteCell.vertices[a], infiniteCell.vertices[b]);
+            cells.push_back(infiniteCell);
+        }
+
+        link({1, 2, 3, 4});
+    }
+
+    // connects faces of the cells that are not connected yet (matching faces are found via open addressing hash table)
+    void link(const std::vector<CellIndex>& newCells) {
+        static constexpr auto empty = std::numeric_limits<std::uint32_t>::max();
+
+        auto mask = std::bit_ceil(8 * newCells.size()) - 1;
+        table.assign(mask + 1, empty);
+        faces.clear();
+
+        for (auto cell : newCells) {
+            for (size_t i = 0; i < 4; ++i) {
+                if (cells[cell].neighbors[i] != noCell) {
+                    continue;
+                }
+
+                auto face = Face{{}, cell, i};
+                for (size_t j = 0, k = 0; j < 4; ++j) {
+                    if (j != i) {
+                        face.vertices[k++] = cells[cell].vertices[j];
+                    }
+                }
+                std::sort(face.vertices.begin(), face.vertices.end());
+
+                auto hash = (std::uint64_t(face.vertices[0]) * 0x9E3779B97F4A7C15ull) ^ (std::uint64_t(face.vertices[1]) * 0xC2B2AE3D27D4EB4Full) ^
+                            (std::uint64_t(face.vertices[2]) * 0x165667B19E3779F9ull);
+                for (auto slot = (hash >> 32) & mask;; slot = (slot + 1) & mask) {
+                    if (table[slot] == empty) {
+                        table[slot] = static_cast<std::uint32_t>(faces.size());
+                        faces.push_back(face);
+                        break;
+                    }
+
+                    const auto& other = faces[table[slot]];
+                    if (other.vertices == face.vertices) {
+                        cells[cell].neighbors[i] = other.cell;
+                        cells[other.cell].neighbors[other.index] = cell;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    int orientation(const std::array<VertexIndex, 4>& vertices) const {
+        return predicates::Orientation(points[vertices[0]], points[vertices[1]], points[vertices[2]], points[vertices[3]]);
+    }
+
+    // orientation of the cell with one of the vertices replaced by p
+    int orientation(CellIndex cell, size_t index, VertexIndex p) const {
+        auto vertices = cells[cell].vertices;
+        vertices[index] = p;
+        return orientation(vertices);
+    }
+
+    size_t infiniteIndex(CellIndex cell) const {
+        const auto& vertices = cells[cell].vertices;
+        return static_cast<size_t>(std::find(vertices.begin(), vertices.end(), infinite) - vertices.begin());
+    }
+
+    // true if p is inside of the circumsphere of the cell (for infinite cells - if it is on the outer side of the hull face)
+    bool inConflict(CellIndex cell, VertexIndex p) const {
+        auto i = infiniteIndex(cell);
+        if (i == 4) {
+            return finiteConflict(cell, p);
+        }
+
+        auto side = orientation(cell, i, p);
+        if (side != 0) {
+            return side > 0;
+        }
+
+        // p is in the plane of the hull face, it is in conflict if it is inside of the circumcircle of the face
+        auto neighbor = cells[cell].neighbors[i];
+        const auto& neighborCell = cells[neighbor];
+        auto d = neighborCell.vertices[std::find(neighborCell.neighbors.begin(), neighborCell.neighbors.end(), cell) - neighborCell.neighbors.begin()];
+
+        auto triangle = std::array<VertexIndex, 3>();
+        for (size_t j = 0, k = 0; j < 4; ++j) {
+            if (j != i) {
+                triangle[k++] = cells[cell].vertices[j];
+            }
+        }
+        return inCircle(points, triangle, p, d);
+    }
+
+    bool finiteConflict(CellIndex cell, VertexIndex p) const {
+        const auto& vertices = cells[cell].vertices;
+        auto side = predicates::SideOfOrientedSphere(points[vertices[0]], points[vertices[1]], points[vertices[2]], points[vertices[3]], points[p]);
+        if (side != 0) {
+            return side > 0;
+        }
+
+        auto sorted = std::array{vertices[0], vertices[1], vertices[2], vertices[3], p};
+        std::sort(sorted.begin(), sorted.end(), PerturbationOrder{&points});
+        for (size_t i = 4; i > 1; --i) {
+            if (sorted[i] == p) {
+                return false;
+            }
+
+            auto index = static_cast<size_t>(std::find(vertices.begin(), vertices.end(), sorted[i]) - vertices.begin());
+            auto orientation_ = orientation(cell, index, p);
+            if (orientation_ != 0) {
+                return orientation_ > 0;
+            }
+        }
+
+        LOG_ASSERT(false && "degenerate perturbation");
+        return false;
+    }
+
+    // returns a cell that is in conflict with p (remembering stochastic walk)
+    CellIndex locate(VertexIndex p, CellIndex cell) {
+        auto i = infiniteIndex(cell);
+        if (i != 4) {
+            cell = cells[cell].neighbors[i];
+        }
+
+        auto previous = noCell;
+        while (infiniteIndex(cell) == 4) {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+
+            auto next = noCell;
+            for (size_t k = 0; k < 4; ++k) {
+                auto j = (k + random) % 4;
+                auto neighbor = cells[cell].neighbors[j];
+                if (neighbor != previous && orientation(cell, j, p) < 0) {
+                    next = neighbor;
+                    break;
+                }
+            }
+
+            if (next == noCell) {
+                break;
+            }
+            previous = cell;
+            cell = next;
+        }
+
+        return cell;
+    }
+
+    // inserts vertex and returns one of the new cells
+    CellIndex insert(VertexIndex p, CellIndex start) {
+        ++generation;
+        auto conflictMark = 2 * generation + 1;
+        auto outsideMark = 2 * generation;
+
+        auto cell = locate(p, start);
+        LOG_ASSERT(inConflict(cell, p));
+
+        // find cells that are in conflict (they form a star-shaped cavity around p) and faces of the cavity boundary
+        cavity.clear();
+        boundary.clear();
+        cavity.push_back(cell);
+        cells[cell].mark = conflictMark;
+        for (size_t k = 0; k < cavity.size(); ++k) {
+            auto current = cavity[k];
+            for (size_t i = 0; i < 4; ++i) {
+                auto neighbor = cells[current].neighbors[i];
+                auto& mark = cells[neighbor].mark;
+                if (mark != conflictMark && mark != outsideMark) {
+                    mark = inConflict(neighbor, p) ? conflictMark : outsideMark;
+                    if (mark == conflictMark) {
+                        cavity.push_back(neighbor);
+                    }
+                }
+                if (mark == outsideMark) {
+                    boundary.emplace_back(current, i);
+                }
+            }
+        }
+
+        // connect every boundary face to p
+        newCells.clear();
+        for (const auto& [current, i] : boundary) {
+            auto newCell = Cell{cells[current].vertices, {noCell, noCell, noCell, noCell}};
+            newCell.vertices[i] = p;
+            newCell.neighbors[i] = cells[current].neighbors[i];
+
+            auto index = allocate(newCell);
+            auto& outside = cells[newCell.neighbors[i]];
+            *std::find(outside.neighbors.begin(), outside.neighbors.end(), current) = index;
+            newCells.push_back(index);
+        }
+
+        for (auto current : cavity) {
+            cells[current].alive = false;
+            freeCells.push_back(current);
+        }
+
+        link(newCells);
+
+        return newCells.front();
+    }
+
+    CellIndex allocate(const Cell& cell) {
+        // cells of the cavity are released after all new cells are allocated
+        if (!freeCells.empty()) {
+            auto index = freeCells.back();
+            freeCells.pop_back();
+            cells[index] = cell;
+            return index;
+        }
+
+        cells.push_back(cell);
+        return static_cast<CellIndex>(cells.size() - 1);
+    }
+
+ private:
+    const std::vector<Point>& points;
+    std::vector<Cell> cells;
+    std::vector<CellIndex> freeCells;
+
+    std::uint32_t generation = 0;
+    std::uint32_t random = 2463534242;
+
+    // buffers reused by insertions
+    std::vector<CellIndex> cavity;
+    std::vector<std::pair<CellIndex, size_t>> boundary;
+    std::vector<CellIndex> newCells;
+    std::vector<Face> faces;
+    std::vector<std::uint32_t> table;
+};
+
+// interleaves bits of the coordinates quantized to 21 bits
+std::uint64_t mortonCode(const Point& point, const Point& min, const Point& scale) {
+    auto code = std::uint64_t(0);
+    for (size_t axis = 0; axis < 3; ++axis) {
+        auto value = static_cast<std::uint64_t>((point[axis] - min[axis]) * scale[axis]);
+        for (size_t bit = 0; bit < 21; ++bit) {
+            code |= ((value >> bit) & 1) << (3 * bit + axis);
+        }
+    }
+    return code;
+}
+
+// points are inserted in the order of the Morton curve, so that consecutive points are close to each other
+std::vector<VertexIndex> insertionOrder(const std::vector<Point>& points) {
+    auto min = points.front();
+    auto max = points.front();
+    for (const auto& point : points) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    auto scale = Point();
+    for (size_t axis = 0; axis < 3; ++axis) {
+        auto extent = max[axis] - min[axis];
+        scale[axis] = extent > 0.0 ? double((1 << 21) - 1) / extent : 0.0;
+    }
+
+    auto codes = std::vector<std::pair<std::uint64_t, VertexIndex>>();
+    codes.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        codes.emplace_back(mortonCode(points[i], min, scale), static_cast<VertexIndex>(i));
+    }
+    std::sort(codes.begin(), codes.end());
+
+    auto order = std::vector<VertexIndex>();
+    order.reserve(points.size());
+    for (const auto& [code, i] : codes) {
+        order.push_back(i);
+    }
+    return order;
+}
+
+// incremental (Bowyer-Watson) Delaunay triangulation of coplanar points, orientation of the plane is given by a point outside of it,
+// same structure as Triangulation (with triangles instead of tetrahedra)
+class CoplanarTriangulation {
+ public:
+    CoplanarTriangulation(const std::vector<Point>& points_, VertexIndex outside_) : points(points_), outside(outside_) {
+    }
+
+    // inserts points (except of the outside one) in their order, first is a triangle of points that are not collinear
+    void Build(const std::array<VertexIndex, 3>& first) {
+        // there are about 2 triangles per vertex
+        triangles.reserve(2 * points.size() + 4);
+        initialize(first);
+
+        auto start = TriangleIndex(0);
+        for (VertexIndex vertex = 0; vertex < points.size(); ++vertex) {
+            if (vertex != outside && std::find(first.begin(), first.end(), vertex) == first.end()) {
+                start = insert(vertex, start);
+            }
+        }
+    }
+
+    // original[v] is the index of the vertex v in the input, edges are sorted
+    std::vector<Edge> GetEdges(const std::vector<VertexIndex>& original) const {
+        auto edges = std::vector<Edge>();
+        for (const auto& triangle : triangles) {
+            if (!triangle.alive) {
+                continue;
+            }
+
+            for (size_t i = 0; i < 3; ++i) {
+                auto v1 = triangle.vertices[i];
+                auto v2 = triangle.vertices[(i + 1) % 3];
+                // every finite edge is shared by two triangles, it is added by one of them
+                if (v1 != infinite && v2 != infinite && v1 < v2) {
+                    edges.push_back({std::min(original[v1], original[v2]), std::max(original[v1], original[v2])});
+                }
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+        return edges;
+    }
+
+ private:
+    using TriangleIndex = CellIndex;
+
+    // finite triangles are positively oriented (seen from the outside point),
+    // infinite triangles are oriented as if the infinite vertex was a point on the outer side of their hull edge
+    struct Triangle {
+        std::array<VertexIndex, 3> vertices;
+        // neighbors[i] shares the edge opposite to vertices[i]
+        std::array<TriangleIndex, 3> neighbors;
+        // generation of the last conflict test (odd - in conflict, even - not in conflict)
+        std::uint32_t mark = 0;
+        bool alive = true;
+    };
+
+    void initialize(std::array<VertexIndex, 3> vertices) {
+        if (orientation(vertices) < 0) {
+            std::swap(vertices[0], vertices[1]);
+        }
+
+        triangles.push_back({vertices, {1, 2, 3}});
+        for (size_t i = 0; i < 3; ++i) {
+            auto infiniteTriangle = Triangle{vertices, {noCell, noCell, noCell}};
+            infiniteTriangle.vertices[i] = infinite;
+            infiniteTriangle.neighbors[i] = 0;
+            // flip orientation by swapping two other vertices
+            std::swap(infiniteTriangle.vertices[(i + 1) % 3], infiniteTriangle.vertices[(i + 2) % 3]);
+            triangles.push_back(infiniteTriangle);
+        }
+
+        link({1, 2, 3});
+    }
+
+    // connects edges of the triangles that are not connected yet, such edges share a vertex of every triangle
+    // (the inserted or the infinite one), so they are matched by their other vertex
+    void link(const std::vector<TriangleIndex>& newTriangles) {
+        edges.clear();
+        for (auto triangle : newTriangles) {
+            for (size_t i = 0; i < 3; ++i) {
+                if (triangles[triangle].neighbors[i] == noCell) {
+                    const auto& vertices = triangles[triangle].vertices;
+                    edges.push_back({std::minmax(vertices[(i + 1) % 3], vertices[(i + 2) % 3]), triangle, i});
+                }
+            }
+        }
+
+        std::sort(edges.begin(), edges.end(), [](const EdgeOfTriangle& a, const EdgeOfTriangle& b) { return a.vertices < b.vertices; });
+        for (size_t k = 0; k + 1 < edges.size(); k += 2) {
+            const auto& a = edges[k];
+            const auto& b = edges[k + 1];
+            LOG_ASSERT(a.vertices == b.vertices);
+            triangles[a.triangle].neighbors[a.index] = b.triangle;
+            triangles[b.triangle].neighbors[b.index] = a.triangle;
+        }
+    }
+
+    int orientation(const std::array<VertexIndex, 3>& vertices) const {
+        return predicates::Orientation(points[vertices[0]], points[vertices[1]], points[vertices[2]], points[outside]);
+    }
+
+    // orientation of the triangle with one of the vertices replaced by p
+    int orientation(TriangleIndex triangle, size_t index, VertexIndex p) const {
+        auto vertices = triangles[triangle].vertices;
+        vertices[index] = p;
+        return orientation(vertices);
+    }
+
+    size_t infiniteIndex(TriangleIndex triangle) const {
+        const auto& vertices = triangles[triangle].vertices;
+        return static_cast<size_t>(std::find(vertices.begin(), vertices.end(), infinite) - vertices.begin());
+    }
+
+    // true if p is inside of the circumcircle of the triangle (for infinite triangles - if it is on the outer side of the hull edge)
+    bool inConflict(TriangleIndex triangle, VertexIndex p) const {
+        const auto& vertices = triangles[triangle].vertices;
+        auto i = infiniteIndex(triangle);
+        if (i == 3) {
+            return inCircle(points, vertices, p, outside);
+        }
+
+        auto side = orientation(triangle, i, p);
+        if (side != 0) {
+            return side > 0;
+        }
+
+        // p is on the line of the hull edge, it is in conflict if it is inside of the edge (lexicographic order is the order along the line)
+        const auto& a = points[vertices[(i + 1) % 3]];
+        const auto& b = points[vertices[(i + 2) % 3]];
+        const auto& q = points[p];
+        return (predicates::LexicographicallyLess(a, q) && predicates::LexicographicallyLess(q, b)) ||
+               (predicates::LexicographicallyLess(b, q) && predicates::LexicographicallyLess(q, a));
+    }
+
+    // returns a triangle that is in conflict with p (remembering stochastic walk)
+    TriangleIndex locate(VertexIndex p, TriangleIndex triangle) {
+        auto i = infiniteIndex(triangle);
+        if (i != 3) {
+            triangle = triangles[triangle].neighbors[i];
+        }
+
+        auto previous = noCell;
+        while (infiniteIndex(triangle) == 3) {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+
+            auto next = noCell;
+            for (size_t k = 0; k < 3; ++k) {
+                auto j = (k + random) % 3;
+                auto neighbor = triangles[triangle].neighbors[j];
+                if (neighbor != previous && orientation(triangle, j, p) < 0) {
+                    next = neighbor;
+                    break;
+                }
+            }
+
+            if (next == noCell) {
+                break;
+            }
+            previous = triangle;
+            triangle = next;
+        }
+
+        return triangle;
+    }
+
+    // inserts vertex and returns one of the new triangles
+    TriangleIndex insert(VertexIndex p, TriangleIndex start) {
+        ++generation;
+        auto conflictMark = 2 * generation + 1;
+        auto outsideMark = 2 * generation;
+
+        auto triangle = locate(p, start);
+        LOG_ASSERT(inConflict(triangle, p));
+
+        // find triangles that are in conflict (they form a star-shaped cavity around p) and edges of the cavity boundary
+        cavity.clear();
+        boundary.clear();
+        cavity.push_back(triangle);
+        triangles[triangle].mark = conflictMark;
+        for (size_t k = 0; k < cavity.size(); ++k) {
+            auto current = cavity[k];
+            for (size_t i = 0; i < 3; ++i) {
+                auto neighbor = triangles[current].neighbors[i];
+                auto& mark = triangles[neighbor].mark;
+                if (mark != conflictMark && mark != outsideMark) {
+                    mark = inConflict(neighbor, p) ? conflictMark : outsideMark;
+                    if (mark == conflictMark) {
+                        cavity.push_back(neighbor);
+                    }
+                }
+                if (mark == outsideMark) {
+                    boundary.emplace_back(current, i);
+                }
+            }
+        }
+
+        // connect every boundary edge to p
+        newTriangles.clear();
+        for (const auto& [current, i] : boundary) {
+            auto newTriangle = Triangle{triangles[current].vertices, {noCell, noCell, noCell}};
+            newTriangle.vertices[i] = p;
+            newTriangle.neighbors[i] = triangles[current].neighbors[i];
+
+            auto index = allocate(newTriangle);
+            auto& outsideTriangle = triangles[newTriangle.neighbors[i]];
+            *std::find(outsideTriangle.neighbors.begin(), outsideTriangle.neighbors.end(), current) = index;
+            newTriangles.push_back(index);
+        }
+
+        for (auto current : cavity) {
+            triangles[current].alive = false;
+            freeTriangles.push_back(current);
+        }
+
+        link(newTriangles);
+
+        return newTriangles.front();
+    }
+
+    TriangleIndex allocate(const Triangle& triangle) {
+        // triangles of the cavity are released after all new triangles are allocated
+        if (!freeTriangles.empty()) {
+            auto index = freeTriangles.back();
+            freeTriangles.pop_back();
+            triangles[index] = triangle;
+            return index;
+        }
+
+        triangles.push_back(triangle);
+        return static_cast<TriangleIndex>(triangles.size() - 1);
     }
 
-    auto T = Delaunay(points.begin(), points.end());
-    LOG_ASSERT(T.number_of_vertices() == pointsVec.size());
-    LOG_ASSERT(T.is_valid());
+ private:
+    struct EdgeOfTriangle {
+        std::pair<VertexIndex, VertexIndex> vertices;
+        TriangleIndex triangle;
+        size_t index;
+    };
+
+    const std::vector<Point>& points;
+    VertexIndex outside;
+    std::vector<Triangle> triangles;
+    std::vector<TriangleIndex> freeTriangles;
+
+    std::uint32_t generation = 0;
+    std::uint32_t random = 2463534242;
+
+    // buffers reused by insertions
+    std::vector<TriangleIndex> cavity;
+    std::vector<std::pair<TriangleIndex, size_t>> boundary;
+    std::vector<TriangleIndex> newTriangles;
+    std::vector<EdgeOfTriangle> edges;
+};
 
-    for (const auto& v : T.finite_vertex_handles()) {
-        LOG_ASSERT(points[v->info()].first == v->point());
+// triangulation of coplanar (or collinear) points
+std::vector<Edge> lowerDimensionalDelaunay(const std::vector<Point>& points) {
+    auto n = points.size();
+    if (n < 2) {
+        return {};
     }
 
-    auto edges = std::vector<Edge>();
-    for (const auto& e : T.finite_edges()) {
-        const auto v1 = e.first->vertex(e.second)->info();
-        const auto v2 = e.first->vertex(e.third)->info();
+    auto sorted = std::vector<VertexIndex>(n);
+    for (size_t i = 0; i < n; ++i) {
+        sorted[i] = static_cast<VertexIndex>(i);
+    }
+    std::sort(sorted.begin(), sorted.end(), PerturbationOrder{&points});
+
+    auto third = std::find_if(sorted.begin(), sorted.end(), [&](VertexIndex v) { return !predicates::Collinear(points[sorted[0]], points[sorted[1]], points[v]); });
+    if (third == sorted.end()) {
+        // collinear points are connected in the order along the line
+        auto edges = std::vector<Edge>();
+        for (size_t i = 0; i + 1 < n; ++i) {
+            edges.push_back({std::min(sorted[i], sorted[i + 1]), std::max(sorted[i], sorted[i + 1])});
+        }
+        std::sort(edges.begin(), edges.end());
+        return edges;
+    }
 
-        edges.push_back({std::min(v1, v2), std::max(v1, v2)});
+    // vertices are renumbered in the insertion order (as in Delaunay3D), the point outside of the plane orients it for the 2D predicates
+    auto order = insertionOrder(points);
+    auto orderedPoints = std::vector<Point>();
+    orderedPoints.reserve(n + 1);
+    auto position = std::vector<VertexIndex>(n);
+    for (size_t i = 0; i < n; ++i) {
+        orderedPoints.push_back(points[order[i]]);
+        position[order[i]] = static_cast<VertexIndex>(i);
     }
+    const auto& p0 = points[sorted[0]];
+    auto normal = glm::cross(points[sorted[1]] - p0, points[*third] - p0);
+    orderedPoints.push_back(p0 + normal);
+    auto outside = static_cast<VertexIndex>(n);
+    LOG_ASSERT(predicates::Orientation(p0, points[sorted[1]], points[*third], orderedPoints[outside]) != 0);
+
+    auto triangulation = CoplanarTriangulation(orderedPoints, outside);
+    triangulation.Build({position[sorted[0]], position[sorted[1]], position[*third]});
+    return triangulation.GetEdges(order);
+}
 
-    std::sort(edges.begin(), edges.end());
+}  // namespace
+
+std::vector<Edge> Delaunay3D(const std::vector<glm::vec3>& pointsVec) {
+    auto points = std::vector<Point>(pointsVec.begin(), pointsVec.end());
+    LOG_ASSERT(points.size() < infinite);
+    if (points.empty()) {
+        return {};
+    }
+
+    auto sorted = std::vector<VertexIndex>(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        sorted[i] = static_cast<VertexIndex>(i);
+    }
+    std::sort(sorted.begin(), sorted.end(), PerturbationOrder{&points});
+    LOG_ASSERT(std::adjacent_find(sorted.begin(), sorted.end(), [&](VertexIndex a, VertexIndex b) { return points[a] == points[b]; }) == sorted.end());
+
+    // vertices are renumbered in the insertion order, so that points that are close in space are also close in memory
+    auto order = insertionOrder(points);
+    auto orderedPoints = std::vector<Point>();
+    orderedPoints.reserve(points.size());
+    for (auto i : order) {
+        orderedPoints.push_back(points[i]);
+    }
+
+    auto triangulation = Triangulation(orderedPoints);
+    if (!triangulation.Build()) {
+        return lowerDimensionalDelaunay(points);
+    }
 
-    return edges;
+    return triangulation.GetEdges(order);
 }
 
 bool Edge::operator==(const Edge& other) const {
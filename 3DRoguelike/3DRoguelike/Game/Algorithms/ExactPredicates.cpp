@@ -0,0 +1,392 @@
+#include "ExactPredicates.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace predicates {
+
+namespace {
+
+// Arbitrary precision signed integer, only operations needed by the predicates are supported.
+class BigInt {
+ public:
+    BigInt() = default;
+
+    // value * 2^shift
+    BigInt(std::int64_t value, int shift) : negative(value < 0) {
+        auto absolute = value < 0 ? ~static_cast<std::uint64_t>(value) + 1 : static_cast<std::uint64_t>(value);
+
+        magnitude.assign(static_cast<size_t>(shift / 32), 0);
+        shift %= 32;
+
+        auto low = absolute << shift;
+        auto high = shift == 0 ? 0 : absolute >> (64 - shift);
+        magnitude.push_back(static_cast<std::uint32_t>(low));
+        magnitude.push_back(static_cast<std::uint32_t>(low >> 32));
+        magnitude.push_back(static_cast<std::uint32_t>(high));
+        trim();
+    }
+
+    int Sign() const {
+        return magnitude.empty() ? 0 : (negative ? -1 : 1);
+    }
+
+    friend BigInt operator-(BigInt a) {
+        a.negative = !a.negative;
+        a.trim();
+        return a;
+    }
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b) {
+        if (a.negative == b.negative) {
+            return BigInt(a.negative, addMagnitudes(a.magnitude, b.magnitude));
+        }
+        if (compareMagnitudes(a.magnitude, b.magnitude) >= 0) {
+            return BigInt(a.negative, subtractMagnitudes(a.magnitude, b.magnitude));
+        }
+        return BigInt(b.negative, subtractMagnitudes(b.magnitude, a.magnitude));
+    }
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b) {
+        return a + (-b);
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        auto result = std::vector<std::uint32_t>(a.magnitude.size() + b.magnitude.size(), 0);
+        for (size_t i = 0; i < a.magnitude.size(); ++i) {
+            auto carry = std::uint64_t(0);
+            for (size_t j = 0; j < b.magnitude.size(); ++j) {
+                auto current = std::uint64_t(a.magnitude[i]) * b.magnitude[j] + result[i + j] + carry;
+                result[i + j] = static_cast<std::uint32_t>(current);
+                carry = current >> 32;
+            }
+            result[i + b.magnitude.size()] = static_cast<std::uint32_t>(carry);
+        }
+        return BigInt(a.negative != b.negative, std::move(result));
+    }
+
+ private:
+    BigInt(bool negative_, std::vector<std::uint32_t> magnitude_) : negative(negative_), magnitude(std::move(magnitude_)) {
+        trim();
+    }
+
+    void trim() {
+        while (!magnitude.empty() && magnitude.back() == 0) {
+            magnitude.pop_back();
+        }
+        if (magnitude.empty()) {
+            negative = false;
+        }
+    }
+
+    static int compareMagnitudes(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+        if (a.size() != b.size()) {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static std::vector<std::uint32_t> addMagnitudes(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+        auto result = std::vector<std::uint32_t>(std::max(a.size(), b.size()) + 1, 0);
+        auto carry = std::uint64_t(0);
+        for (size_t i = 0; i + 1 < result.size(); ++i) {
+            auto current = carry + (i < a.size() ? a[i] : 0) + (i < b.size() ? b[i] : 0);
+            result[i] = static_cast<std::uint32_t>(current);
+            carry = current >> 32;
+        }
+        result.back() = static_cast<std::uint32_t>(carry);
+        return result;
+    }
+
+    // |a| >= |b|
+    static std::vector<std::uint32_t> subtractMagnitudes(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+        auto result = std::vector<std::uint32_t>(a.size(), 0);
+        auto borrow = std::int64_t(0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            auto current = std::int64_t(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+            borrow = current < 0 ? 1 : 0;
+            result[i] = static_cast<std::uint32_t>(current + (borrow << 32));
+        }
+        return result;
+    }
+
+ private:
+    bool negative = false;
+    // little-endian, without leading zeros
+    std::vector<std::uint32_t> magnitude;
+};
+
+template <typename T>
+using Vector = std::array<T, 3>;
+
+// coordinates of the points as integers (multiples of the largest power of two that divides all of them)
+template <size_t N>
+struct GridCoordinates {
+    // coordinate is mantissa * 2^(shift + minExponent)
+    struct Component {
+        std::int64_t mantissa = 0;
+        int shift = 0;
+    };
+
+    explicit GridCoordinates(const std::array<const Point*, N>& points) {
+        auto exponents = std::array<std::array<int, 3>, N>();
+        auto minExponent = std::numeric_limits<int>::max();
+        for (size_t i = 0; i < N; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                auto value = (*points[i])[k];
+                if (value == 0.0) {
+                    continue;
+                }
+
+                auto exponent = 0;
+                auto fraction = std::frexp(value, &exponent);
+                auto mantissa = static_cast<std::int64_t>(std::ldexp(fraction, 53));
+                exponent -= 53;
+                while (mantissa % 2 == 0) {
+                    mantissa /= 2;
+                    ++exponent;
+                }
+
+                components[i][k].mantissa = mantissa;
+                exponents[i][k] = exponent;
+                minExponent = std::min(minExponent, exponent);
+            }
+        }
+
+        for (size_t i = 0; i < N; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                components[i][k].shift = components[i][k].mantissa == 0 ? 0 : exponents[i][k] - minExponent;
+            }
+        }
+    }
+
+    // differences of the points with the last point
+    std::array<Vector<BigInt>, N - 1> ExactDifferences() const {
+        auto last = Vector<BigInt>();
+        for (int k = 0; k < 3; ++k) {
+            last[k] = BigInt(components[N - 1][k].mantissa, components[N - 1][k].shift);
+        }
+
+        auto result = std::array<Vector<BigInt>, N - 1>();
+        for (size_t i = 0; i + 1 < N; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                result[i][k] = BigInt(components[i][k].mantissa, components[i][k].shift) - last[k];
+            }
+        }
+        return result;
+    }
+
+    // differences of the points with the last point, if all of them are smaller than limit
+    std::optional<std::array<Vector<std::int64_t>, N - 1>> SmallDifferences(std::int64_t limit) const {
+        auto integers = std::array<std::array<std::int64_t, 3>, N>();
+        for (size_t i = 0; i < N; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                const auto& c = components[i][k];
+                if (c.shift + std::bit_width(static_cast<std::uint64_t>(c.mantissa < 0 ? -c.mantissa : c.mantissa)) > 62) {
+                    return std::nullopt;
+                }
+                integers[i][k] = c.mantissa * (std::int64_t(1) << c.shift);
+            }
+        }
+
+        auto result = std::array<Vector<std::int64_t>, N - 1>();
+        for (size_t i = 0; i + 1 < N; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                result[i][k] = integers[i][k] - integers[N - 1][k];
+                if (result[i][k] >= limit || result[i][k] <= -limit) {
+                    return std::nullopt;
+                }
+            }
+        }
+        return result;
+    }
+
+    std::array<std::array<Component, 3>, N> components;
+};
+
+int sign(double value) {
+    return (value > 0.0) - (value < 0.0);
+}
+
+static constexpr double epsilon = std::numeric_limits<double>::epsilon() / 2.0;
+// error bounds of the floating point evaluation (J. R. Shewchuk, Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates)
+static constexpr double orientationErrorBound = (7.0 + 56.0 * epsilon) * epsilon;
+static constexpr double sphereErrorBound = (16.0 + 224.0 * epsilon) * epsilon;
+
+// determinant of the rows a - d, b - d, c - d (it is equal to -Orientation(a, b, c, d))
+template <typename T>
+T orientationDeterminant(const T& adx, const T& ady, const T& adz, const T& bdx, const T& bdy, const T& bdz, const T& cdx, const T& cdy, const T& cdz) {
+    return adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy) + cdz * (adx * bdy - bdx * ady);
+}
+
+int exactOrientation(const Point& p, const Point& q, const Point& r, const Point& s) {
+    auto grid = GridCoordinates<4>(std::array{&p, &q, &r, &s});
+
+    // degenerate cases usually come from points on a small grid, their determinant fits into 64-bit integer (6 * limit^3 < 2^63)
+    if (auto small = grid.SmallDifferences(std::int64_t(1) << 19)) {
+        const auto& [ad, bd, cd] = small.value();
+        auto det = orientationDeterminant(ad[0], ad[1], ad[2], bd[0], bd[1], bd[2], cd[0], cd[1], cd[2]);
+        return (det < 0) - (det > 0);
+    }
+
+    const auto& [ad, bd, cd] = grid.ExactDifferences();
+    return -orientationDeterminant(ad[0], ad[1], ad[2], bd[0], bd[1], bd[2], cd[0], cd[1], cd[2]).Sign();
+}
+
+// determinant of the rows (a - e, |a - e|^2), ..., (d - e, |d - e|^2), positive if e is inside of the sphere abcd when Orientation(a, b, c, d) is negative
+template <typename T>
+T sphereDeterminant(const std::array<Vector<T>, 4>& v) {
+    const auto& [ae, be, ce, de] = v;
+    auto ab = ae[0] * be[1] - be[0] * ae[1];
+    auto bc = be[0] * ce[1] - ce[0] * be[1];
+    auto cd = ce[0] * de[1] - de[0] * ce[1];
+    auto da = de[0] * ae[1] - ae[0] * de[1];
+    auto ac = ae[0] * ce[1] - ce[0] * ae[1];
+    auto bd = be[0] * de[1] - de[0] * be[1];
+
+    auto abc = ae[2] * bc - be[2] * ac + ce[2] * ab;
+    auto bcd = be[2] * cd - ce[2] * bd + de[2] * bc;
+    auto cda = ce[2] * da + de[2] * ac + ae[2] * cd;
+    auto dab = de[2] * ab + ae[2] * bd + be[2] * da;
+
+    auto lift = [](const Vector<T>& u) { return u[0] * u[0] + u[1] * u[1] + u[2] * u[2]; };
+
+    return (lift(de) * abc - lift(ce) * dab) + (lift(be) * cda - lift(ae) * bcd);
+}
+
+int exactSideOfOrientedSphere(const Point& p, const Point& q, const Point& r, const Point& s, const Point& t) {
+    auto grid = GridCoordinates<5>(std::array{&p, &q, &r, &s, &t});
+
+    // same as for orientation (72 * limit^5 < 2^63)
+    if (auto small = grid.SmallDifferences(std::int64_t(1) << 11)) {
+        auto det = sphereDeterminant(small.value());
+        return (det < 0) - (det > 0);
+    }
+
+    return -sphereDeterminant(grid.ExactDifferences()).Sign();
+}
+
+template <typename T>
+Vector<T> cross(const Vector<T>& u, const Vector<T>& v) {
+    return {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+}
+
+template <typename T>
+T dot(const Vector<T>& u, const Vector<T>& v) {
+    return u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+}
+
+// in-circle determinant of coplanar points p + u, p + v, p + w (with respect to p) expressed with vectors along the normal of the plane,
+// projected onto the normal, positive if p + w is outside of the circle
+template <typename T>
+T circleDeterminant(const std::array<Vector<T>, 3>& rows) {
+    const auto& [u, v, w] = rows;
+    auto normal = cross(u, v);
+    auto vw = cross(v, w);
+    auto uw = cross(u, w);
+    auto uu = dot(u, u);
+    auto vv = dot(v, v);
+    auto ww = dot(w, w);
+
+    auto det = T();
+    for (size_t k = 0; k < 3; ++k) {
+        det = det + (uu * vw[k] - vv * uw[k] + ww * normal[k]) * normal[k];
+    }
+    return det;
+}
+
+}  // namespace
+
+int Orientation(const Point& p, const Point& q, const Point& r, const Point& s) {
+    auto adx = p.x - s.x;
+    auto bdx = q.x - s.x;
+    auto cdx = r.x - s.x;
+    auto ady = p.y - s.y;
+    auto bdy = q.y - s.y;
+    auto cdy = r.y - s.y;
+    auto adz = p.z - s.z;
+    auto bdz = q.z - s.z;
+    auto cdz = r.z - s.z;
+
+    auto det = orientationDeterminant(adx, ady, adz, bdx, bdy, bdz, cdx, cdy, cdz);
+    auto permanent = (std::abs(bdx * cdy) + std::abs(cdx * bdy)) * std::abs(adz) + (std::abs(cdx * ady) + std::abs(adx * cdy)) * std::abs(bdz) +
+                     (std::abs(adx * bdy) + std::abs(bdx * ady)) * std::abs(cdz);
+    if (std::abs(det) > orientationErrorBound * permanent) {
+        return -sign(det);
+    }
+
+    return exactOrientation(p, q, r, s);
+}
+
+bool Collinear(const Point& p, const Point& q, const Point& r) {
+    auto grid = GridCoordinates<3>(std::array{&q, &r, &p});
+
+    // 2 * limit^2 < 2^63
+    if (auto small = grid.SmallDifferences(std::int64_t(1) << 31)) {
+        const auto& [u, v] = small.value();
+        return cross(u, v) == Vector<std::int64_t>();
+    }
+
+    const auto& [u, v] = grid.ExactDifferences();
+    auto normal = cross(u, v);
+    return normal[0].Sign() == 0 && normal[1].Sign() == 0 && normal[2].Sign() == 0;
+}
+
+int SideOfOrientedSphere(const Point& p, const Point& q, const Point& r, const Point& s, const Point& t) {
+    auto rows = std::array<std::array<double, 3>, 4>();
+    auto points = std::array{&p, &q, &r, &s};
+    for (size_t i = 0; i < 4; ++i) {
+        rows[i] = {points[i]->x - t.x, points[i]->y - t.y, points[i]->z - t.z};
+    }
+
+    auto det = sphereDeterminant(rows);
+
+    // same as determinant, but with absolute values of all products
+    auto absolute = std::array<std::array<double, 3>, 4>();
+    for (size_t i = 0; i < 4; ++i) {
+        absolute[i] = {std::abs(rows[i][0]), std::abs(rows[i][1]), std::abs(rows[i][2])};
+    }
+    const auto& [ae, be, ce, de] = absolute;
+    auto plus = [](const std::array<double, 3>& u, const std::array<double, 3>& v) { return u[0] * v[1] + v[0] * u[1]; };
+    auto lift = [](const std::array<double, 3>& u) { return u[0] * u[0] + u[1] * u[1] + u[2] * u[2]; };
+    auto permanent = (plus(ce, de) * be[2] + plus(de, be) * ce[2] + plus(be, ce) * de[2]) * lift(ae) +
+                     (plus(de, ae) * ce[2] + plus(ae, ce) * de[2] + plus(ce, de) * ae[2]) * lift(be) +
+                     (plus(ae, be) * de[2] + plus(be, de) * ae[2] + plus(de, ae) * be[2]) * lift(ce) +
+                     (plus(be, ce) * ae[2] + plus(ce, ae) * be[2] + plus(ae, be) * ce[2]) * lift(de);
+    if (std::abs(det) > sphereErrorBound * permanent) {
+        return -sign(det);
+    }
+
+    return exactSideOfOrientedSphere(p, q, r, s, t);
+}
+
+int CoplanarSideOfBoundedCircle(const Point& p, const Point& q, const Point& r, const Point& t) {
+    // rare case (only for points on the convex hull), so there is no floating point filter
+    auto grid = GridCoordinates<4>(std::array{&q, &r, &t, &p});
+
+    // 108 * limit^6 < 2^63
+    if (auto small = grid.SmallDifferences(std::int64_t(1) << 9)) {
+        auto det = circleDeterminant(small.value());
+        return (det < 0) - (det > 0);
+    }
+
+    return -circleDeterminant(grid.ExactDifferences()).Sign();
+}
+
+bool LexicographicallyLess(const Point& p, const Point& q) {
+    return std::tie(p.x, p.y, p.z) < std::tie(q.x, q.y, q.z);
+}
+
+}  // namespace predicates
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Exact geometric predicates for points with double coordinates.
+// Predicates are evaluated in floating point with an error bound first, and exactly (with arbitrary precision integers)
+// only if the sign of the floating point result is uncertain.
+namespace predicates {
+
+using Point = glm::dvec3;
+
+// sign of det(q - p, r - p, s - p), positive if s is on the positive side of the oriented plane pqr
+int Orientation(const Point& p, const Point& q, const Point& r, const Point& s);
+
+// true if p, q and r lie on one line
+bool Collinear(const Point& p, const Point& q, const Point& r);
+
+// for positively oriented p, q, r, s: positive if t is inside of their circumsphere, negative if it is outside, zero if it is on the sphere
+int SideOfOrientedSphere(const Point& p, const Point& q, const Point& r, const Point& s, const Point& t);
+
+// for coplanar p, q, r, t (p, q, r are not collinear): positive if t is inside of the circumcircle of pqr,
+// negative if it is outside, zero if it is on the circle
+int CoplanarSideOfBoundedCircle(const Point& p, const Point& q, const Point& r, const Point& t);
+
+// lexicographic order of points (by x, then y, then z)
+bool LexicographicallyLess(const Point& p, const Point& q);
+
+}  // namespace predicates
@@ -1,32 +1,73 @@
 #include "MST.h"
 
-#include <iterator>
+#include <numeric>
+#include <queue>
 #include <utility>
 
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/kruskal_min_spanning_tree.hpp>
+#include "../Assert.h"
 
-using namespace boost;
-using Graph = adjacency_list<vecS, vecS, undirectedS, no_property, property<edge_weight_t, Weight>>;
-using B_Edge = graph_traits<Graph>::edge_descriptor;
-using Vertex = graph_traits<Graph>::vertex_descriptor;
-using E = std::pair<size_t, size_t>;
+namespace {
 
-std::vector<Edge> MinimumSpanningTree(const std::vector<Edge>& graph, size_t vertices, const std::vector<Weight>& weights) {
-    auto edgeVec = std::vector<E>();
-    for (const auto& edge : graph) {
-        edgeVec.push_back({edge.v1, edge.v2});
+// disjoint set union with path halving and union by size
+class DisjointSets {
+ public:
+    explicit DisjointSets(size_t count) : parents(count), sizes(count, 1) {
+        std::iota(parents.begin(), parents.end(), size_t(0));
+    }
+
+    size_t Find(size_t v) {
+        while (parents[v] != v) {
+            parents[v] = parents[parents[v]];
+            v = parents[v];
+        }
+        return v;
+    }
+
+    // returns false if a and b are already in the same set
+    bool Unite(size_t a, size_t b) {
+        a = Find(a);
+        b = Find(b);
+        if (a == b) {
+            return false;
+        }
+
+        if (sizes[a] < sizes[b]) {
+            std::swap(a, b);
+        }
+        parents[b] = a;
+        sizes[a] += sizes[b];
+        return true;
     }
-    auto g = Graph(edgeVec.begin(), edgeVec.end(), weights.begin(), vertices);
 
-    auto spanning_tree = std::vector<B_Edge>();
+ private:
+    std::vector<size_t> parents;
+    std::vector<size_t> sizes;
+};
+
+}  // namespace
 
-    kruskal_minimum_spanning_tree(g, std::back_inserter(spanning_tree));
+// Kruskal's algorithm.
+// Edges are taken from a heap in the same way as in boost::kruskal_minimum_spanning_tree, so that edges with equal weights are chosen in the same order.
+std::vector<Edge> MinimumSpanningTree(const std::vector<Edge>& graph, size_t vertices, const std::vector<Weight>& weights) {
+    LOG_ASSERT(graph.size() == weights.size());
+
+    auto greater = [&](size_t a, size_t b) { return weights[a] > weights[b]; };
+    auto indices = std::vector<size_t>();
+    indices.reserve(graph.size());
+    auto queue = std::priority_queue<size_t, std::vector<size_t>, decltype(greater)>(greater, std::move(indices));
+    for (size_t i = 0; i < graph.size(); ++i) {
+        queue.push(i);
+    }
 
+    auto sets = DisjointSets(vertices);
     auto edges = std::vector<Edge>();
+    while (!queue.empty() && edges.size() + 1 < vertices) {
+        const auto& edge = graph[queue.top()];
+        queue.pop();
 
-    for (const auto& edge : spanning_tree) {
-        edges.push_back(Edge{source(edge, g), target(edge, g)});
+        if (sets.Unite(edge.v1, edge.v2)) {
+            edges.push_back(edge);
+        }
     }
 
     return edges;
@@ -229,7 +229,8 @@ Pathfinder::PathCost Pathfinder::costFunction(const NodePtr a, const NodePtr b,
     return pathCost;
 }
 
-void PlacePathWithStairs(const std::vector<glm::ivec3>& path, TilesVec& world, const Tile& wall, const Tile& air, const Tile& stairsAir) {
+std::vector<glm::ivec3> PlacePathWithStairs(const std::vector<glm::ivec3>& path, TilesVec& world, const Tile& wall, const Tile& air,
+                                            const Tile& stairsAir) {
     LOG_DURATION("Pathfinder - PlacePathWithStairs");
 
     // place air and stairs tiles
@@ -315,4 +316,6 @@ void PlacePathWithStairs(const std::vector<glm::ivec3>& path, TilesVec& world, c
             }
         }
     }
+
+    return totalPath;
 }
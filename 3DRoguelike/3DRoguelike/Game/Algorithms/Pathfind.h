@@ -65,8 +65,10 @@ class Pathfinder {
                           const glm::ivec3& target);
 
  private:
-    Vector3D<Node> grid;
+    Vector3D<Node, TilesLayout> grid;
     Queue queue;
 };
 
-void PlacePathWithStairs(const std::vector<glm::ivec3>& path, TilesVec& world, const Tile& wall, const Tile& air, const Tile& stairs);
+// returns tiles of the corridor (path and stairs)
+std::vector<glm::ivec3> PlacePathWithStairs(const std::vector<glm::ivec3>& path, TilesVec& world, const Tile& wall, const Tile& air,
+                                            const Tile& stairs);
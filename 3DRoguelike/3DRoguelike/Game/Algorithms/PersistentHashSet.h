@@ -77,10 +77,14 @@ class ImmerPersistentVector {
     }
 
     bool contains(const T& value) const {
-        return GetBit(vector.at(value / bits), value % bits);
+        return value / bits < vector.size() && GetBit(vector[value / bits], value % bits);
     }
 
     void insert(const T& value) {
+        if (value / bits >= vector.size()) {
+            grow(value / bits + 1);
+        }
+
         auto val = vector.at(value / bits);
         vector = std::move(vector).set(value / bits, SetBit(val, value % bits));
     }
@@ -90,13 +94,27 @@ class ImmerPersistentVector {
     }
 
  private:
-    using Vector = immer::vector<Bitmap>;
+    // vectors are never shared between threads, so reference counting does not have to be atomic,
+    // but free lists have to be thread local (default policy with IMMER_NO_THREAD_SAFETY uses a global one)
+    using MemoryPolicy = immer::memory_policy<immer::free_list_heap_policy<immer::cpp_heap>, immer::unsafe_refcount_policy, immer::no_lock_policy>;
+    using Vector = immer::vector<Bitmap, MemoryPolicy>;
 
-    static const Vector& EmptyVector() {
-        static const Vector vec = Vector(size, 0);
+    static Vector& EmptyVector() {
+        thread_local Vector vec = Vector(size, 0);
         return vec;
     }
 
+    // grows both this vector and the empty vector, so that the next sets start with enough space
+    void grow(size_t newSize) {
+        auto& empty = EmptyVector();
+        while (empty.size() < newSize) {
+            empty = std::move(empty).push_back(0);
+        }
+        while (vector.size() < newSize) {
+            vector = std::move(vector).push_back(0);
+        }
+    }
+
     static inline bool GetBit(Bitmap value, int bit) {
         return value & (Bitmap(1) << bit);
     }
@@ -108,8 +126,8 @@ class ImmerPersistentVector {
     Vector vector;
 
     static constexpr size_t bits = std::numeric_limits<Bitmap>::digits;
+    // initial size (enough for the default dungeon size), vector grows if larger values are inserted
     static constexpr size_t size = (60 * 30 * 60 + bits - 1) / bits;
-    static constexpr size_t elems = size * bits;
 };
 
 template <typename T>
@@ -0,0 +1,103 @@
+#include "BackgroundGenerator.h"
+
+#include <utility>
+
+#include "../Utility/MeasureStatistics.h"
+
+BackgroundGenerator::BackgroundGenerator(Dungeon dungeon_, RenderDataBuilder buildRenderData_)
+    : back(std::move(dungeon_)),
+      backData(),
+      buildRenderData(std::move(buildRenderData_)),
+      mutex(),
+      condition(),
+      requested(),
+      generating(false),
+      ready(false),
+      cancellation(),
+      seed(0),
+      progress(0.0f),
+      worker([this](std::stop_token stopToken) { run(stopToken); }) {
+}
+
+void BackgroundGenerator::Request(SeedType seed_) {
+    {
+        auto lock = std::lock_guard(mutex);
+        requested = seed_;
+        if (generating) {
+            cancellation.request_stop();
+        }
+    }
+    condition.notify_all();
+}
+
+bool BackgroundGenerator::IsBusy() const {
+    auto lock = std::lock_guard(mutex);
+    return requested.has_value() || generating || ready;
+}
+
+SeedType BackgroundGenerator::GetSeed() const {
+    return seed;
+}
+
+float BackgroundGenerator::GetProgress() const {
+    return progress;
+}
+
+bool BackgroundGenerator::TrySwap(Dungeon& dungeon, TileRenderData& data) {
+    {
+        auto lock = std::lock_guard(mutex);
+        if (!ready) {
+            return false;
+        }
+
+        std::swap(dungeon, back);
+        // callback of the worker captures the generator, it must not be called from the game's dungeon
+        dungeon.SetProgressCallback(nullptr);
+        data = std::move(backData);
+        ready = false;
+    }
+    condition.notify_all();
+
+    return true;
+}
+
+void BackgroundGenerator::run(std::stop_token stopToken) {
+    auto lock = std::unique_lock(mutex);
+    while (true) {
+        // back dungeon can be reused only after it is swapped
+        if (!condition.wait(lock, stopToken, [&]() { return requested.has_value() && !ready; })) {
+            return;
+        }
+
+        auto nextSeed = requested.value();
+        requested.reset();
+        generating = true;
+        cancellation = std::stop_source();
+        auto jobCancellation = cancellation;
+        lock.unlock();
+
+        // generation is also cancelled when the worker is stopped
+        auto stopCallback = std::stop_callback(stopToken, [&]() { jobCancellation.request_stop(); });
+
+        seed = nextSeed;
+        progress = 0.0f;
+
+        // statistics are collected per thread, so report of the worker contains only this generation
+        util::Reset();
+
+        back.SetProgressCallback([this](float value) { progress = value; });
+        back.SetSeed(nextSeed);
+
+        auto state = GenerationState();
+        auto generated = back.Generate(state, jobCancellation.get_token());
+        if (generated) {
+            backData = buildRenderData(back);
+            util::PrintReport();
+        }
+
+        lock.lock();
+        generating = false;
+        // level is not shown if newer one was requested during generation
+        ready = generated && !requested.has_value();
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+#include "Dungeon.h"
+#include "TileRenderData.h"
+
+// Generates dungeons on a worker thread.
+// Worker generates the level into its own (back) dungeon and builds render data for it,
+// then main thread swaps it with the dungeon that is currently used (between frames).
+class BackgroundGenerator {
+ public:
+    using RenderDataBuilder = std::function<TileRenderData(const Dungeon&)>;
+
+    // dungeon should be configured in the same way as the one that is used by the game,
+    // buildRenderData is called on the worker thread
+    BackgroundGenerator(Dungeon dungeon_, RenderDataBuilder buildRenderData_);
+
+    BackgroundGenerator(const BackgroundGenerator&) = delete;
+    BackgroundGenerator& operator=(const BackgroundGenerator&) = delete;
+
+    // requests generation of the level, replaces the previous request,
+    // generation of the previous level is cancelled (at the next room or corridor boundary) if it has already started
+    void Request(SeedType seed_);
+
+    // true if there is a request that is not swapped in yet
+    bool IsBusy() const;
+    // seed and progress (in range [0, 1]) of the level that is being generated
+    SeedType GetSeed() const;
+    float GetProgress() const;
+
+    // if the requested level is generated, swaps it with the dungeon, moves its render data to data and returns true
+    bool TrySwap(Dungeon& dungeon, TileRenderData& data);
+
+ private:
+    void run(std::stop_token stopToken);
+
+ private:
+    Dungeon back;
+    TileRenderData backData;
+    RenderDataBuilder buildRenderData;
+
+    mutable std::mutex mutex;
+    std::condition_variable_any condition;
+    std::optional<SeedType> requested;
+    bool generating;
+    bool ready;
+    // cancels generation of the current request
+    std::stop_source cancellation;
+
+    std::atomic<SeedType> seed;
+    std::atomic<float> progress;
+
+    // declared last, so that the worker is stopped before the rest of the members are destroyed
+    std::jthread worker;
+};
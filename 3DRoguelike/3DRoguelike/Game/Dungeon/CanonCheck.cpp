@@ -0,0 +1,173 @@
+#include "CanonCheck.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// streaming hash, every word is mixed into the state with SplitMix64 finalizer
+class Hasher {
+ public:
+    void Add(std::uint64_t word) {
+        state = mix(state ^ word);
+    }
+
+    std::uint64_t Get() const {
+        return state;
+    }
+
+ private:
+    static std::uint64_t mix(std::uint64_t z) {
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+ private:
+    std::uint64_t state = 0xcbf29ce484222325ull;
+};
+
+std::string tileToString(int type) {
+    return type < 0 ? "missing" : std::to_string(type);
+}
+
+std::string describeDifference(const glm::ivec3& coords, int expected, int actual) {
+    return "first differing tile (" + std::to_string(coords.x) + ", " + std::to_string(coords.y) + ", " + std::to_string(coords.z) +
+           "): expected " + tileToString(expected) + ", got " + tileToString(actual);
+}
+
+}  // namespace
+
+std::uint64_t ContentHash(const TilesVec& tiles) {
+    const auto& dimensions = tiles.GetDimensions();
+
+    auto hasher = Hasher();
+    hasher.Add(dimensions.width);
+    hasher.Add(dimensions.height);
+    hasher.Add(dimensions.length);
+
+    // tile types are packed 8 per word
+    auto word = std::uint64_t(0);
+    auto packed = 0;
+    for (size_t x = 0; x < dimensions.width; ++x) {
+        for (size_t y = 0; y < dimensions.height; ++y) {
+            for (size_t z = 0; z < dimensions.length; ++z) {
+                word = (word << 8) | static_cast<std::uint64_t>(tiles.Get(x, y, z).type);
+                if (++packed == 8) {
+                    hasher.Add(word);
+                    word = 0;
+                    packed = 0;
+                }
+            }
+        }
+    }
+    hasher.Add(word);
+
+    tiles.ForEachBorderElement([&](const glm::ivec3& coords, const Tile& tile) {
+        if (tile.type == TileType::Void) return;
+        hasher.Add(static_cast<std::uint32_t>(coords.x));
+        hasher.Add(static_cast<std::uint32_t>(coords.y));
+        hasher.Add(static_cast<std::uint32_t>(coords.z));
+        hasher.Add(static_cast<std::uint64_t>(tile.type));
+    });
+
+    return hasher.Get();
+}
+
+CanonManifest::CanonManifest(std::string filename_) : filename(std::move(filename_)), hashes() {
+    auto file = std::ifstream(filename);
+
+    auto name = std::string();
+    auto hash = std::uint64_t(0);
+    while (file >> name >> std::hex >> hash) {
+        hashes[name] = hash;
+    }
+}
+
+std::optional<std::uint64_t> CanonManifest::Find(const std::string& name) const {
+    auto it = hashes.find(name);
+    if (it == hashes.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void CanonManifest::Record(const std::string& name, std::uint64_t hash) {
+    hashes[name] = hash;
+
+    auto file = std::ofstream(filename);
+    for (const auto& [entryName, entryHash] : hashes) {
+        file << entryName << " " << std::hex << std::setw(16) << std::setfill('0') << entryHash << "\n";
+    }
+}
+
+std::optional<std::string> FindFirstDifference(const TilesVec& tiles, const std::string& canonFilename) {
+    auto file = std::ifstream(canonFilename);
+    if (!file) {
+        return "canon file " + canonFilename + " not found";
+    }
+
+    const auto& dimensions = tiles.GetDimensions();
+
+    // canon file consists of lines "<index> <type>" for tiles of the grid and "<x> <y> <z> <type>" for border tiles
+    auto expected = std::vector<int>(Volume(dimensions), -1);
+    auto expectedBorder = std::unordered_map<glm::ivec3, int>();
+
+    auto line = std::string();
+    while (std::getline(file, line)) {
+        auto stream = std::istringstream(line);
+        auto values = std::vector<long long>();
+        for (auto value = 0ll; stream >> value;) {
+            values.push_back(value);
+        }
+
+        if (values.size() == 2 && values[0] >= 0 && static_cast<size_t>(values[0]) < expected.size()) {
+            expected[values[0]] = static_cast<int>(values[1]);
+        } else if (values.size() == 4) {
+            expectedBorder[glm::ivec3(values[0], values[1], values[2])] = static_cast<int>(values[3]);
+        } else if (!values.empty()) {
+            return "canon file " + canonFilename + " has invalid line \"" + line + "\"";
+        }
+    }
+
+    for (size_t x = 0; x < dimensions.width; ++x) {
+        for (size_t y = 0; y < dimensions.height; ++y) {
+            for (size_t z = 0; z < dimensions.length; ++z) {
+                auto coords = glm::ivec3(x, y, z);
+                auto expectedType = expected[CoordinatesToIndex(coords, dimensions)];
+                auto actualType = static_cast<int>(tiles.Get(coords).type);
+                if (expectedType != actualType) {
+                    return describeDifference(coords, expectedType, actualType);
+                }
+            }
+        }
+    }
+
+    // border tiles that are not in the canon file are void
+    auto difference = std::optional<std::string>();
+    tiles.ForEachBorderElement([&](const glm::ivec3& coords, const Tile& tile) {
+        auto it = expectedBorder.find(coords);
+        auto expectedType = it != expectedBorder.end() ? it->second : static_cast<int>(TileType::Void);
+        auto actualType = static_cast<int>(tile.type);
+        if (!difference.has_value() && expectedType != actualType) {
+            difference = describeDifference(coords, expectedType, actualType);
+        }
+    });
+    if (difference.has_value()) {
+        return difference;
+    }
+
+    // canon tiles outside of the border
+    for (const auto& [coords, expectedType] : expectedBorder) {
+        if (!tiles.IsInBoundsOrBorder(coords) && expectedType != static_cast<int>(TileType::Void)) {
+            return describeDifference(coords, expectedType, static_cast<int>(TileType::Void));
+        }
+    }
+
+    return std::nullopt;
+}
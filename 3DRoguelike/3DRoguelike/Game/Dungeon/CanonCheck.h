@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "WorldGrid.h"
+
+// regression check of the generator, generated dungeons are compared with the canon ones
+enum class CanonCheck {
+    // no check
+    None,
+    // content hash of the dungeon is compared with the hash from the canon manifest
+    Hash,
+    // dungeon is compared tile by tile with the canon text file (see Dungeon::Serialize), first differing tile is reported
+    FullDiff,
+    // content hash of the dungeon is written to the canon manifest
+    Record
+};
+
+// 64-bit hash of tile types of the grid and non-void border tiles (same information as in the canon text file),
+// does not depend on the memory layout of the grid
+std::uint64_t ContentHash(const TilesVec& tiles);
+
+// Canon hashes of dungeons, stored in text file with lines "<name> <hash>".
+class CanonManifest {
+ public:
+    // file is read once, missing file is treated as empty manifest
+    explicit CanonManifest(std::string filename_);
+
+    std::optional<std::uint64_t> Find(const std::string& name) const;
+    // adds or updates the hash and rewrites the file
+    void Record(const std::string& name, std::uint64_t hash);
+
+ private:
+    std::string filename;
+    std::map<std::string, std::uint64_t> hashes;
+};
+
+// compares tiles with the canon text file, returns description of the first differing tile (in linear order),
+// or std::nullopt if tiles are equal to the canon ones
+std::optional<std::string> FindFirstDifference(const TilesVec& tiles, const std::string& canonFilename);
@@ -6,20 +6,68 @@
 #include <vector>
 #include <set>
 #include <fstream>
+#include <limits>
+#include <utility>
 
 #include "../Algorithms/Pathfind.h"
 #include "../Algorithms/Delaunay3D.h"
 #include "../Algorithms/MST.h"
 
-#include "../Assets.h"
+#include "DungeonFormat.h"
+
 #include "../Utility/LogDuration.h"
-#include "../Utility/CompareFiles.h"
+#include "../Utility/MappedFile.h"
 #include "../Utility/MeasureStatistics.h"
 
 static const auto offset = glm::ivec3(5, 5, 5);
 
+// corridor walls can be placed at most one tile outside of the grid
+static const size_t border = 1;
+
+// part of the generation progress taken by room placement (corridors take the rest, they are much slower)
+static const float roomsProgress = 0.1f;
+
+namespace {
+
+// purposes of RNG substreams
+enum class Stream : std::uint64_t { Room = 1, ExtraEdges, ShuffleEdges, Corridor, StartingRoom };
+
+// in counter mode every purpose draws from its own substream (stored in substream),
+// in legacy mode everything is drawn from rng sequentially
+RNG& selectStream(RNG& rng, std::optional<RNG>& substream, Stream purpose, size_t index = 0) {
+    if (rng.GetMode() == RNGMode::Counter) {
+        return substream.emplace(rng.Substream(static_cast<std::uint64_t>(purpose), index));
+    }
+    return rng;
+}
+
+}  // namespace
+
+GenerationState::GenerationState() = default;
+GenerationState::~GenerationState() = default;
+GenerationState::GenerationState(GenerationState&&) noexcept = default;
+GenerationState& GenerationState::operator=(GenerationState&&) noexcept = default;
+
 Dungeon::Dungeon(const Dimensions& dimensions_, SeedType seed_)
-    : dimensions(FromIVec3(AsIVec3(dimensions_) + 2 * offset)), seed(seed_), rng(seed), tiles(dimensions, Tile()), rooms(), renderer(), spawn() {
+    : dimensions(FromIVec3(AsIVec3(dimensions_) + 2 * offset)),
+      seed(seed_),
+      rng(seed),
+      tiles(dimensions, Tile(), border),
+      regions(dimensions),
+      portals(),
+      editedTiles(),
+      rooms(),
+      corridorCount(0),
+      spawn(),
+      roomCount(10),
+      roomPlacement(RoomPlacement::Rejection),
+      startingRoom(),
+      canonCheck(CanonCheck::Hash),
+      canonManifest(),
+      verbose(true),
+      levelCache(nullptr),
+      levelKey(),
+      progressCallback() {
 }
 
 void Dungeon::SetSeed(SeedType seed_) {
@@ -31,61 +79,138 @@ SeedType Dungeon::GetSeed() const {
     return seed;
 }
 
-// only one room type for now
-Room getRandomRoom(RNG& rng) {
+void Dungeon::SetRNGMode(RNGMode mode) {
+    rng = RNG(seed, mode);
+}
+
+void Dungeon::SetRoomPlacement(RoomPlacement roomPlacement_) {
+    roomPlacement = roomPlacement_;
+}
+
+void Dungeon::SetRoomCount(size_t roomCount_) {
+    roomCount = roomCount_;
+}
+
+void Dungeon::SetStartingRoom(std::optional<size_t> startingRoom_) {
+    startingRoom = startingRoom_;
+}
+
+void Dungeon::SetCanonCheck(CanonCheck canonCheck_) {
+    canonCheck = canonCheck_;
+}
+
+void Dungeon::SetVerbose(bool verbose_) {
+    verbose = verbose_;
+}
+
+void Dungeon::SetLevelCache(LevelCache* levelCache_) {
+    levelCache = levelCache_;
+}
+
+void Dungeon::SetProgressCallback(std::function<void(float)> progressCallback_) {
+    progressCallback = std::move(progressCallback_);
+}
+
+RoomType getRandomRoomType(RNG& rng) {
     if (rng.RandomBool(0.33f)) {
-        return std::make_shared<OvalRoom>();
+        return RoomType::Oval;
     } else if (rng.RandomBool(0.5f)) {
-        return std::make_shared<EllipsoidRoom>();
+        return RoomType::Ellipsoid;
     } else {
-        return std::make_shared<RectRoom>();
+        return RoomType::Rect;
     }
 }
 
-void Dungeon::placeRooms() {
-    LOG_DURATION("Dungeon::placeRooms");
-    MEASURE_STAT(generateRooms);
-
-    auto tries = 1000;
-    auto roomCnt = 10;
-
-    do {
-        auto newRoom = getRandomRoom(rng);
+std::optional<Room> Dungeon::generateRoom(const GenerationState& state) {
+    auto newRoom = Room();
+    auto roomOffset = std::optional<glm::ivec3>();
+
+    if (rng.GetMode() == RNGMode::Counter) {
+        // every attempt has its own stream, so that rooms do not depend on each other
+        auto roomRng = rng.Substream(static_cast<std::uint64_t>(Stream::Room), state.attempt);
+        auto type = getRandomRoomType(roomRng);
+        // room seed, it is not used, but still drawn so that the stream stays the same
+        roomRng.IntUniform<SeedType>(SeedType(0), SeedType(-1));
+        newRoom = GenerateRoom(type, roomRng);
+        roomOffset = drawRoomOffset(roomRng, newRoom.size, state);
+    } else {
+        auto type = getRandomRoomType(rng);
         auto roomSeed = rng.IntUniform<SeedType>(SeedType(0), SeedType(-1));
         auto newSeed = rng.IntUniform<SeedType>(SeedType(0), SeedType(-1));
 
         SetSeed(roomSeed);
-        newRoom->Generate(rng, roomSeed);
-        newRoom->offset = rng.RandomIVec3(offset, AsIVec3(dimensions) - AsIVec3(newRoom->size) - offset);
+        newRoom = GenerateRoom(type, rng);
+        roomOffset = drawRoomOffset(rng, newRoom.size, state);
         SetSeed(newSeed);
+    }
+
+    if (!roomOffset.has_value()) {
+        return std::nullopt;
+    }
+    newRoom.offset = roomOffset.value();
+    return newRoom;
+}
 
+// in rejection mode offset is drawn from the whole level (room is rejected later if it intersects other rooms),
+// in free space mode it is drawn only from the offsets where the room does not touch other rooms
+std::optional<glm::ivec3> Dungeon::drawRoomOffset(RNG& roomRng, const Dimensions& size, const GenerationState& state) const {
+    auto min = offset;
+    auto max = AsIVec3(dimensions) - AsIVec3(size) - offset;
+    if (glm::any(glm::lessThan(max, min))) {
+        return std::nullopt;
+    }
+
+    if (roomPlacement == RoomPlacement::Rejection) {
+        return roomRng.RandomIVec3(min, max);
+    }
+
+    auto positions = state.freeSpace.FreePositions(size, min, max);
+    if (positions.empty()) {
+        return std::nullopt;
+    }
+    return positions[roomRng.IntUniform<size_t>(0, positions.size() - 1)];
+}
+
+void Dungeon::placeRoom(GenerationState& state) {
+    MEASURE_STAT(generateRooms);
+
+    auto newRoom = generateRoom(state);
+    ++state.attempt;
+
+    if (!newRoom.has_value()) {
+        // no other room fits, the rest of the attempts would fail too
+        auto max = AsIVec3(dimensions) - AsIVec3(MinRoomSize()) - offset;
+        if (roomPlacement == RoomPlacement::FreeSpace && !state.freeSpace.HasFreePosition(MinRoomSize(), offset, max)) {
+            state.roomTries = 1;
+        }
+        return;
+    }
+
+    // free space positions do not need the checks
+    if (roomPlacement == RoomPlacement::Rejection) {
         if (!BoxFitsIntoBox(Box{newRoom->offset, newRoom->size}, Box{glm::ivec3(), dimensions})) {
-            continue;
+            return;
         }
 
-        auto intersect = false;
         for (const auto& room : rooms) {
-            if (RoomsIntersect(room, newRoom)) {
-                intersect = true;
-                break;
+            if (RoomsIntersect(room, newRoom.value())) {
+                return;
             }
         }
-        if (intersect) {
-            continue;
-        }
+    } else {
+        state.freeSpace.Occupy(Box{newRoom->offset - 1, FromIVec3(AsIVec3(newRoom->size) + 2)});
+    }
 
-        --roomCnt;
-        newRoom->Place(tiles);
-        rooms.push_back(newRoom);
-    } while (--tries > 0 && roomCnt != 0);
+    --state.roomsLeft;
+    newRoom->Place(tiles);
+    rooms.push_back(std::move(newRoom.value()));
+    markRegion(Box{rooms.back().offset, rooms.back().size}, static_cast<RegionId>(rooms.size()));
+    reportProgress(roomsProgress * static_cast<float>(rooms.size()) / static_cast<float>(roomCount));
 }
 
-void Dungeon::placeCorridors() {
-    LOG_DURATION("Dungeon::placeCorridors");
+void Dungeon::beginCorridors(GenerationState& state) {
     MEASURE_STAT(generateCorridors);
 
-    auto air = Tile{TileType::CorridorAir, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
-
     // determine which rooms should be connected
 
     auto points = std::vector<glm::vec3>();
@@ -106,130 +231,338 @@ void Dungeon::placeCorridors() {
     auto mstEdges = MinimumSpanningTree(edges, points.size(), weights);
 
     // add some edges from triangulation to MST edges
+    auto substream = std::optional<RNG>();
+
     auto finalEdges = std::set<Edge>(mstEdges.begin(), mstEdges.end());
+    auto& extraEdgesRng = selectStream(rng, substream, Stream::ExtraEdges);
     for (const auto& edge : edges) {
-        if (rng.RandomBool(0.2f)) {
+        if (extraEdgesRng.RandomBool(0.2f)) {
             finalEdges.insert(edge);
         }
     }
 
     // shuffle edges randomly (but deterministically)
-    auto shuffledEdges = std::vector<Edge>(finalEdges.begin(), finalEdges.end());
-    std::sort(shuffledEdges.begin(), shuffledEdges.end());
-    rng.Shuffle(shuffledEdges.begin(), shuffledEdges.end());
+    state.edges = std::vector<Edge>(finalEdges.begin(), finalEdges.end());
+    std::sort(state.edges.begin(), state.edges.end());
+    selectStream(rng, substream, Stream::ShuffleEdges).Shuffle(state.edges.begin(), state.edges.end());
 
-    LOG_DURATION("Dungeon::placeCorridors - finding paths");
+    corridorCount = state.edges.size();
+    LOG_ASSERT(rooms.size() + corridorCount <= std::numeric_limits<RegionId>::max());
+    state.corridor = 0;
+    state.pathfinder = std::make_unique<Pathfinder>(dimensions);
 
-    // connect rooms with corridors
-    auto pathfinder = Pathfinder(dimensions);
+    if (verbose) {
+        std::cout << "Connecting rooms..." << std::endl;
+    }
+}
 
-    std::cout << "Connecting rooms..." << std::endl;
-    for (auto [v1, v2] : shuffledEdges) {
-        if (rng.RandomBool()) {
-            std::swap(v1, v2);
-        }
+void Dungeon::placeCorridor(GenerationState& state) {
+    MEASURE_STAT(generateCorridors);
 
-        std::cout << v1 << " " << v2 << std::endl;
+    auto air = Tile{TileType::CorridorAir, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
 
-        const auto& r1 = rooms[v1];
-        const auto& r2 = rooms[v2];
+    auto i = state.corridor++;
+    auto [v1, v2] = state.edges[i];
 
-        auto wall = Tile{
-            TileType::Block, TileOrientation::None, TextureType::Texture2,
-            glm::vec3(0.4f, 0.3f, 0.8f) + 0.2f * glm::vec3(rng.RealUniform(-1.0f, 1.0f), rng.RealUniform(-1.0f, 1.0f), rng.RealUniform(-1.0f, 1.0f))};
-        auto stairs = Tile{
-            TileType::StairsAir, TileOrientation::None, TextureType::Texture2,
-            glm::vec3(0.4f, 0.3f, 0.8f) + 0.2f * glm::vec3(rng.RealUniform(-1.0f, 1.0f), rng.RealUniform(-1.0f, 1.0f), rng.RealUniform(-1.0f, 1.0f))};
+    auto substream = std::optional<RNG>();
+    auto& corridorRng = selectStream(rng, substream, Stream::Corridor, i);
 
-        auto startTiles = r1->GetEdgeTiles();
-        auto finishTiles = r2->GetEdgeTiles();
-        for (auto& tile : startTiles) {
-            tile = tile + r1->offset;
-        }
-        for (auto& tile : finishTiles) {
-            tile = tile + r2->offset;
-        }
+    if (corridorRng.RandomBool()) {
+        std::swap(v1, v2);
+    }
 
-        auto path = pathfinder.FindPath(startTiles, finishTiles, RoomCenterCoords(r2), tiles);
-        if (!path.empty()) {
-            PlacePathWithStairs(path, tiles, wall, air, stairs);
-        } else {
-            LOG_ASSERT(false);
-        }
+    if (verbose) {
+        std::cout << v1 << " " << v2 << std::endl;
+    }
+
+    const auto& r1 = rooms[v1];
+    const auto& r2 = rooms[v2];
+
+    auto wall = Tile{
+        TileType::Block, TileOrientation::None, TextureType::Texture2,
+        glm::vec3(0.4f, 0.3f, 0.8f) +
+            0.2f * glm::vec3(corridorRng.RealUniform(-1.0f, 1.0f), corridorRng.RealUniform(-1.0f, 1.0f), corridorRng.RealUniform(-1.0f, 1.0f))};
+    auto stairs = Tile{
+        TileType::StairsAir, TileOrientation::None, TextureType::Texture2,
+        glm::vec3(0.4f, 0.3f, 0.8f) +
+            0.2f * glm::vec3(corridorRng.RealUniform(-1.0f, 1.0f), corridorRng.RealUniform(-1.0f, 1.0f), corridorRng.RealUniform(-1.0f, 1.0f))};
+
+    auto startTiles = r1.GetEdgeTiles();
+    auto finishTiles = r2.GetEdgeTiles();
+    for (auto& tile : startTiles) {
+        tile = tile + r1.offset;
+    }
+    for (auto& tile : finishTiles) {
+        tile = tile + r2.offset;
+    }
+
+    auto path = state.pathfinder->FindPath(startTiles, finishTiles, RoomCenterCoords(r2), tiles);
+    if (!path.empty()) {
+        markRegion(PlacePathWithStairs(path, tiles, wall, air, stairs), static_cast<RegionId>(rooms.size() + 1 + i));
+    } else {
+        LOG_ASSERT(false);
     }
+
+    reportProgress(roomsProgress + (1.0f - roomsProgress) * static_cast<float>(i + 1) / static_cast<float>(state.edges.size()));
 }
 
 void Dungeon::reset() {
     LOG_DURATION("Dungeon::reset");
 
     rooms.clear();
-    tiles = TilesVec(dimensions, Tile());
+    corridorCount = 0;
+    tiles = TilesVec(dimensions, Tile(), border);
+    regions = RegionsVec(dimensions);
+    portals.clear();
+    editedTiles.clear();
 }
 
-void addTile(const glm::ivec3& coords, std::vector<PositionColor>& blocks, std::array<std::vector<PositionColor>, 4>& stairs, const TilesVec& tiles) {
-    const auto& tile = tiles.GetInOrOutOfBounds(coords);
-    if (IsSolidBlock(tile.type)) {
-        blocks.push_back({glm::vec3(coords), tile.color, 1.0f});
-    } else if (tile.type == TileType::StairsTopPart && tile.orientation == TileOrientation::North) {
-        stairs[0].push_back({glm::vec3(coords), tile.color, 1.0f});
-    } else if (tile.type == TileType::StairsTopPart && tile.orientation == TileOrientation::West) {
-        stairs[1].push_back({glm::vec3(coords), tile.color, 1.0f});
-    } else if (tile.type == TileType::StairsTopPart && tile.orientation == TileOrientation::South) {
-        stairs[2].push_back({glm::vec3(coords), tile.color, 1.0f});
-    } else if (tile.type == TileType::StairsTopPart && tile.orientation == TileOrientation::East) {
-        stairs[3].push_back({glm::vec3(coords), tile.color, 1.0f});
+void Dungeon::markRegion(const Box& box, RegionId id) {
+    for (auto x = box.offset.x; x < box.offset.x + static_cast<int>(box.size.width); ++x) {
+        for (auto y = box.offset.y; y < box.offset.y + static_cast<int>(box.size.height); ++y) {
+            for (auto z = box.offset.z; z < box.offset.z + static_cast<int>(box.size.length); ++z) {
+                auto& region = regions.Get(glm::ivec3(x, y, z));
+                if (region == 0) {
+                    region = id;
+                }
+            }
+        }
+    }
+}
+
+void Dungeon::markRegion(const std::vector<glm::ivec3>& tilesCoords, RegionId id) {
+    for (const auto& coords : tilesCoords) {
+        if (IsInBounds(coords, dimensions) && regions.Get(coords) == 0) {
+            regions.Set(coords, id);
+        }
     }
 }
 
 void Dungeon::Generate() {
+    auto state = GenerationState();
+    Generate(state, std::stop_token());
+}
+
+bool Dungeon::Generate(GenerationState& state, std::stop_token stopToken) {
     LOG_DURATION("Dungeon::Generate");
     MEASURE_STAT(generateDungeon);
 
-    reset();
+    while (state.stage != GenerationStage::Done) {
+        if (stopToken.stop_requested()) {
+            return false;
+        }
+        step(state);
+    }
+
+    return true;
+}
+
+void Dungeon::step(GenerationState& state) {
+    switch (state.stage) {
+        case GenerationStage::Start: {
+            // seed is changed during generation, so the key is saved before it
+            levelKey = LevelKey{seed, dimensions, roomCount, rng.GetMode(), startingRoom, roomPlacement};
+            if (levelCache != nullptr && levelCache->LoadLevel(levelKey, *this)) {
+                reportProgress(1.0f);
+                if (verbose) {
+                    std::cout << "Seed: " << levelKey.seed << " (cached)" << std::endl;
+                }
+                state.cached = true;
+                state.stage = GenerationStage::Finish;
+                return;
+            }
+
+            reset();
+            reportProgress(0.0f);
 
-    std::cout << "Seed: " << seed << std::endl;
+            if (verbose) {
+                std::cout << "Seed: " << seed << std::endl;
+            }
 
-    placeRooms();
-    placeCorridors();
+            state.roomTries = 1000;
+            state.roomsLeft = roomCount;
+            state.attempt = 0;
+            state.freeSpace = roomPlacement == RoomPlacement::FreeSpace ? FreeSpace(dimensions) : FreeSpace();
+            state.stage = GenerationStage::Rooms;
+            return;
+        }
+        case GenerationStage::Rooms: {
+            placeRoom(state);
+            if (--state.roomTries == 0 || state.roomsLeft == 0) {
+                beginCorridors(state);
+                state.stage = GenerationStage::Corridors;
+            }
+            return;
+        }
+        case GenerationStage::Corridors: {
+            if (state.corridor < state.edges.size()) {
+                placeCorridor(state);
+            } else {
+                state.pathfinder.reset();
+                state.stage = GenerationStage::Finish;
+            }
+            return;
+        }
+        case GenerationStage::Finish: {
+            if (!state.cached) {
+                if (rooms.empty()) {
+                    // no room fits into the level
+                    spawn = AsIVec3(dimensions) / 2;
+                } else {
+                    auto substream = std::optional<RNG>();
+                    auto roomIndex = selectStream(rng, substream, Stream::StartingRoom).IntUniform<size_t>(0, rooms.size() - 1);
+                    if (startingRoom.has_value()) {
+                        roomIndex = startingRoom.value();
+                    }
+
+                    const auto& room = rooms[roomIndex];
+                    spawn = RoomCenterCoords(room);
+                }
+
+                if (levelCache != nullptr) {
+                    levelCache->StoreLevel(levelKey, *this);
+                }
+
+                portals = FindPortals(tiles, regions);
+            }
 
-    auto roomIndex = rng.IntUniform<size_t>(0, rooms.size() - 1);
-    if (Assets::HasConfigParameter("starting-room")) {
-        roomIndex = Assets::GetConfigParameter<size_t>("starting-room");
+            checkCanon();
+            state.stage = GenerationStage::Done;
+            return;
+        }
+        case GenerationStage::Done:
+            return;
     }
+}
 
-    const auto& room = rooms[roomIndex];
-    spawn = RoomCenterCoords(room);
+void Dungeon::reportProgress(float progress) const {
+    if (progressCallback) {
+        progressCallback(progress);
+    }
+}
 
-    auto filename = std::to_string(seed) + ".txt";
-    auto canon_filename = "canon_" + filename;
-    Serialize(filename);
+const LevelKey& Dungeon::GetLevelKey() const {
+    return levelKey;
+}
+
+void Dungeon::checkCanon() {
+    if (canonCheck == CanonCheck::None) {
+        return;
+    }
+
+    LOG_DURATION("Dungeon::checkCanon");
+
+    auto mode = rng.GetMode() == RNGMode::Counter ? "_counter" : "";
+    auto name = std::to_string(seed) + mode;
+
+    if (canonCheck == CanonCheck::FullDiff) {
+        auto difference = FindFirstDifference(tiles, "canon_" + name + ".txt");
+        if (difference.has_value()) {
+            std::cout << "Canon test failed, " << difference.value() << "\n";
+        }
+        return;
+    }
+
+    if (!canonManifest.has_value()) {
+        canonManifest.emplace("canon_hashes.txt");
+    }
+
+    auto hash = ContentHash();
+    if (canonCheck == CanonCheck::Record) {
+        canonManifest->Record(name, hash);
+        return;
+    }
 
-    if (!util::FilesAreEqual(canon_filename, filename)) {
+    auto canonHash = canonManifest->Find(name);
+    if (!canonHash.has_value()) {
+        std::cout << "Canon test failed, no canon hash for " << name << "\n";
+    } else if (canonHash.value() != hash) {
         std::cout << "Canon test failed!\n";
         // LOG_ASSERT(false);
     }
 }
 
-void Dungeon::Render() {
-    renderer->RenderTilesInstanced();
-}
-
 const TilesVec& Dungeon::GetTiles() const {
     return tiles;
 }
 
+void Dungeon::SetTile(const glm::ivec3& coords, const Tile& tile) {
+    LOG_ASSERT(IsInBounds(coords, dimensions));
+
+    tiles.Set(coords, tile);
+    editedTiles.push_back(coords);
+
+    if (IsSolidBlock(tile.type)) {
+        return;
+    }
+
+    auto cell = CellOfTile(tile, regions, coords);
+    for (const auto& neighbour : GetNeighbours(coords)) {
+        if (!IsInBounds(neighbour, dimensions) || IsSolidBlock(tiles.Get(neighbour).type)) {
+            continue;
+        }
+
+        auto neighbourCell = CellOfTile(tiles.Get(neighbour), regions, neighbour);
+        if (neighbourCell != cell) {
+            AddPortalFace(portals, cell, coords, neighbourCell, neighbour);
+        }
+    }
+}
+
+std::vector<glm::ivec3> Dungeon::TakeEditedTiles() {
+    return std::exchange(editedTiles, {});
+}
+
+size_t Dungeon::GetRoomCount() const {
+    return rooms.size();
+}
+
+size_t Dungeon::GetCorridorCount() const {
+    return corridorCount;
+}
+
 glm::ivec3 Dungeon::GetSpawnPoint() const {
     return spawn;
 }
 
 size_t Dungeon::WhichRoomPointIsInside(const glm::ivec3& coords) const {
-    for (size_t i = 0; i < rooms.size(); ++i) {
-        if (PointInsideBox(coords, Box{rooms[i]->offset, rooms[i]->size})) {
-            return i;
-        }
+    auto region = GetRegion(coords);
+    return region.type == Region::Type::Room ? region.index : rooms.size();
+}
+
+Region Dungeon::GetRegion(const glm::ivec3& coords) const {
+    auto id = static_cast<size_t>(GetRegionId(coords));
+    if (id == 0) {
+        return Region();
+    }
+    if (id <= rooms.size()) {
+        return Region{Region::Type::Room, id - 1};
     }
+    return Region{Region::Type::Corridor, id - rooms.size() - 1};
+}
 
-    return rooms.size();
+RegionId Dungeon::GetRegionId(const glm::ivec3& coords) const {
+    return IsInBounds(coords, dimensions) ? regions.Get(coords) : RegionId(0);
+}
+
+const RegionsVec& Dungeon::GetRegions() const {
+    return regions;
+}
+
+size_t Dungeon::GetRegionCount() const {
+    return rooms.size() + corridorCount + 1;
+}
+
+const std::vector<Portal>& Dungeon::GetPortals() const {
+    return portals;
+}
+
+RegionId Dungeon::GetPortalCell(const glm::ivec3& coords) const {
+    return CellOfTile(tiles.GetInOrOutOfBounds(coords), regions, coords);
+}
+
+std::uint64_t Dungeon::ContentHash() const {
+    return ::ContentHash(tiles);
 }
 
 void Dungeon::Serialize(std::string filename) const {
@@ -237,15 +570,22 @@ void Dungeon::Serialize(std::string filename) const {
 
     std::vector<std::string> lines;
 
-    size_t i = 0;
-    for (const auto& tile : tiles) {
-        lines.push_back(std::to_string(i++) + " " + std::to_string(static_cast<int>(tile.type)) + "\n");
+    // tiles are written in linear order, so that the file does not depend on the memory layout of the grid
+    for (size_t x = 0; x < dimensions.width; ++x) {
+        for (size_t y = 0; y < dimensions.height; ++y) {
+            for (size_t z = 0; z < dimensions.length; ++z) {
+                auto coords = glm::ivec3{x, y, z};
+                auto index = CoordinatesToIndex(coords, dimensions);
+                lines.push_back(std::to_string(index) + " " + std::to_string(static_cast<int>(tiles.Get(coords).type)) + "\n");
+            }
+        }
     }
 
-    for (const auto& [coords, tile] : tiles.GetOutOfBoundsMap()) {
+    tiles.ForEachBorderElement([&](const glm::ivec3& coords, const Tile& tile) {
+        if (tile.type == TileType::Void) return;
         lines.push_back(std::to_string(coords.x) + " " + std::to_string(coords.y) + " " + std::to_string(coords.z) + " " +
                         std::to_string(static_cast<int>(tile.type)) + "\n");
-    }
+    });
 
     std::sort(lines.begin(), lines.end());
 
@@ -254,24 +594,64 @@ void Dungeon::Serialize(std::string filename) const {
     }
 }
 
-void Dungeon::InitInstancedRendering() {
-    auto tilesData = std::vector<PositionColor>();
-    auto stairsData = std::array<std::vector<PositionColor>, 4>({{}, {}, {}, {}});
+std::vector<std::byte> Dungeon::SerializeBinary() const {
+    auto header = DungeonFormat::Header();
+    header.seed = seed;
+    header.spawn = {spawn.x, spawn.y, spawn.z};
+    header.corridorCount = static_cast<std::uint32_t>(corridorCount);
 
-    for (size_t x = 0; x < dimensions.width; ++x) {
-        for (size_t y = 0; y < dimensions.height; ++y) {
-            for (size_t z = 0; z < dimensions.length; ++z) {
-                auto coords = glm::ivec3{x, y, z};
-                addTile(coords, tilesData, stairsData, tiles);
-            }
-        }
+    auto roomEntries = std::vector<DungeonFormat::RoomEntry>();
+    for (const auto& room : rooms) {
+        roomEntries.push_back(DungeonFormat::RoomEntry{static_cast<std::uint32_t>(room.type),
+                                                       {room.offset.x, room.offset.y, room.offset.z},
+                                                       {static_cast<std::uint32_t>(room.size.width), static_cast<std::uint32_t>(room.size.height),
+                                                        static_cast<std::uint32_t>(room.size.length)}});
     }
-    for (const auto& [coords, tile] : tiles.GetOutOfBoundsMap()) {
-        addTile(coords, tilesData, stairsData, tiles);
+
+    return DungeonFormat::Encode(header, tiles, roomEntries, regions);
+}
+
+void Dungeon::SerializeBinary(const std::string& filename) const {
+    auto bytes = SerializeBinary();
+
+    auto file = std::ofstream(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool Dungeon::LoadBinary(const std::string& filename) {
+    LOG_DURATION("Dungeon::LoadBinary");
+
+    auto file = util::MappedFile();
+    return file.Open(filename) && LoadBinary(file.GetData());
+}
+
+bool Dungeon::LoadBinary(std::span<const std::byte> data) {
+    auto view = DungeonFormat::View();
+    if (!view.Init(data)) {
+        return false;
     }
 
-    if (!renderer) {
-        renderer = std::make_unique<TileRenderer>();
+    const auto& header = view.GetHeader();
+
+    dimensions = view.GetDimensions();
+    seed = header.seed;
+    rng.Seed(seed);
+    spawn = glm::ivec3(header.spawn[0], header.spawn[1], header.spawn[2]);
+    corridorCount = header.corridorCount;
+
+    tiles = TilesVec(dimensions, Tile(), header.border);
+    view.DecodeTiles(tiles);
+    regions = RegionsVec(dimensions);
+    view.DecodeRegions(regions);
+    portals = FindPortals(tiles, regions);
+    editedTiles.clear();
+
+    rooms.clear();
+    for (const auto& entry : view.GetRooms()) {
+        auto roomOffset = glm::ivec3(entry.offset[0], entry.offset[1], entry.offset[2]);
+        auto roomSize = Dimensions{entry.size[0], entry.size[1], entry.size[2]};
+        rooms.push_back(MakeRoom(static_cast<RoomType>(entry.type), roomOffset, roomSize));
     }
-    renderer->InitInstancedRendering(tilesData, stairsData);
+
+    return true;
 }
@@ -1,14 +1,61 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <vector>
 
 #include "Tile.h"
 #include "WorldGrid.h"
-#include "TileRenderer.h"
 #include "Room.h"
+#include "CanonCheck.h"
+#include "FreeSpace.h"
+#include "LevelCache.h"
+#include "Portals.h"
+#include "../Algorithms/Delaunay3D.h"
 #include "../Utility/Random.h"
 
+class Pathfinder;
+
+// room or corridor that contains a tile
+struct Region {
+    enum class Type { None, Room, Corridor };
+
+    Type type = Type::None;
+    // index of the room, or of the corridor in generation order
+    size_t index = 0;
+};
+
+enum class GenerationStage { Start, Rooms, Corridors, Finish, Done };
+
+// State of the step by step generation of a dungeon.
+// Every step is short (one attempt to place a room, or one corridor), so that generation can be interrupted between them.
+struct GenerationState {
+    GenerationState();
+    ~GenerationState();
+    GenerationState(GenerationState&&) noexcept;
+    GenerationState& operator=(GenerationState&&) noexcept;
+
+    GenerationStage stage = GenerationStage::Start;
+    // level was loaded from the cache
+    bool cached = false;
+
+    // rooms stage
+    int roomTries = 0;
+    size_t roomsLeft = 0;
+    size_t attempt = 0;
+    // occupied by placed rooms (only in RoomPlacement::FreeSpace mode)
+    FreeSpace freeSpace;
+
+    // corridors stage
+    std::vector<Edge> edges;
+    size_t corridor = 0;
+    std::unique_ptr<Pathfinder> pathfinder;
+};
+
 class Dungeon {
  public:
     Dungeon(const Dimensions& dimensions_, SeedType seed_ = SeedType());
@@ -16,31 +63,109 @@ class Dungeon {
     void SetSeed(SeedType seed_);
     SeedType GetSeed() const;
 
+    // RNGMode::MersenneTwister reproduces the canon files
+    void SetRNGMode(RNGMode mode);
+
+    // RoomPlacement::Rejection (default) reproduces the canon files
+    void SetRoomPlacement(RoomPlacement roomPlacement_);
+    // number of rooms that generator tries to place
+    void SetRoomCount(size_t roomCount_);
+    // index of the room with spawn point, random if not set
+    void SetStartingRoom(std::optional<size_t> startingRoom_);
+    // compare generated dungeon with the canon one (see CanonCheck.h), CanonCheck::Hash by default
+    void SetCanonCheck(CanonCheck canonCheck_);
+    // print generation progress to console
+    void SetVerbose(bool verbose_);
+    // generated levels are loaded from (and stored to) the cache, cache is not owned, nullptr disables caching
+    void SetLevelCache(LevelCache* levelCache_);
+    // called during generation with progress in range [0, 1] (on the thread that generates the dungeon)
+    void SetProgressCallback(std::function<void(float)> progressCallback_);
+
     void Generate();
-    void Render();
+    // generates dungeon step by step, until it is generated (returns true) or stop is requested (returns false),
+    // interrupted generation is resumed by calling it with the same state
+    bool Generate(GenerationState& state, std::stop_token stopToken);
+    // key of the last generated level
+    const LevelKey& GetLevelKey() const;
 
     const TilesVec& GetTiles() const;
+    // changes a tile of the generated level (in bounds) and records it as edited,
+    // adds openings made by the change to the portals (closed openings are kept, portals stay conservative)
+    void SetTile(const glm::ivec3& coords, const Tile& tile);
+    // coordinates of the tiles changed by SetTile since the last call (render data of their chunks has to be rebuilt, see AddChunksOfTile)
+    std::vector<glm::ivec3> TakeEditedTiles();
+
+    size_t GetRoomCount() const;
+    size_t GetCorridorCount() const;
 
     glm::ivec3 GetSpawnPoint() const;
 
+    // index of the room that contains the point, or room count if there is no such room
     size_t WhichRoomPointIsInside(const glm::ivec3& coords) const;
+    // region lookups are a single read from the region map, points out of bounds have no region
+    Region GetRegion(const glm::ivec3& coords) const;
+    RegionId GetRegionId(const glm::ivec3& coords) const;
+    // region id of every tile (rooms own their bounding boxes, corridors own their air and stairs tiles)
+    const RegionsVec& GetRegions() const;
+    // number of region ids, including 0 (no region)
+    size_t GetRegionCount() const;
+    // openings between the regions, found when the level is generated or loaded
+    const std::vector<Portal>& GetPortals() const;
+    // cell of the portal graph that contains the tile (see CellOfTile), void tiles in the bounding box of a room are outside of it
+    RegionId GetPortalCell(const glm::ivec3& coords) const;
+
+    // hash of the tiles, equal for dungeons with equal canon text files
+    std::uint64_t ContentHash() const;
 
     void Serialize(std::string filename) const;
 
-    void InitInstancedRendering();
+    // compact binary format (see DungeonFormat.h)
+    void SerializeBinary(const std::string& filename) const;
+    std::vector<std::byte> SerializeBinary() const;
+    // restores dungeon from the binary file (memory mapped) without generating it,
+    // returns false if file can not be read or is not valid (dungeon is not changed in that case)
+    // loaded rooms only have type, offset and size
+    bool LoadBinary(const std::string& filename);
+    bool LoadBinary(std::span<const std::byte> data);
 
  private:
-    void placeRooms();
-    void placeCorridors();
+    // returns nullopt if there is no place for the room
+    std::optional<Room> generateRoom(const GenerationState& state);
+    std::optional<glm::ivec3> drawRoomOffset(RNG& roomRng, const Dimensions& size, const GenerationState& state) const;
+    void step(GenerationState& state);
+    void placeRoom(GenerationState& state);
+    void beginCorridors(GenerationState& state);
+    void placeCorridor(GenerationState& state);
+    // marks tiles that do not belong to any region yet
+    void markRegion(const Box& box, RegionId id);
+    void markRegion(const std::vector<glm::ivec3>& tilesCoords, RegionId id);
     void reset();
+    void checkCanon();
+    void reportProgress(float progress) const;
 
  private:
     Dimensions dimensions;
     SeedType seed;
     RNG rng;
     TilesVec tiles;
+    RegionsVec regions;
+    std::vector<Portal> portals;
+    std::vector<glm::ivec3> editedTiles;
     std::vector<Room> rooms;
-    std::unique_ptr<TileRenderer> renderer;
+    size_t corridorCount;
 
     glm::ivec3 spawn;
+
+    size_t roomCount;
+    RoomPlacement roomPlacement;
+    std::optional<size_t> startingRoom;
+    CanonCheck canonCheck;
+    // loaded on the first check
+    std::optional<CanonManifest> canonManifest;
+    bool verbose;
+
+    LevelCache* levelCache;
+    LevelKey levelKey;
+
+    std::function<void(float)> progressCallback;
 };
@@ -0,0 +1,321 @@
+#include "DungeonFormat.h"
+
+#include <cstring>
+#include <map>
+
+#include "Room.h"
+#include "../Assert.h"
+
+namespace DungeonFormat {
+
+namespace {
+
+// palette entries are compared bitwise
+using PaletteKey = std::array<std::uint32_t, 4>;
+
+PaletteKey paletteKey(const PaletteEntry& entry) {
+    auto key = PaletteKey();
+    std::memcpy(key.data(), &entry, sizeof(entry));
+    return key;
+}
+
+template <typename T>
+void append(std::vector<std::byte>& bytes, const T* data, size_t count) {
+    auto begin = reinterpret_cast<const std::byte*>(data);
+    bytes.insert(bytes.end(), begin, begin + count * sizeof(T));
+}
+
+// returns elements of the array starting at offset, and moves offset past them, or empty span if data is too short
+template <typename T>
+std::span<const T> takeArray(std::span<const std::byte> data, size_t& offset, std::uint32_t count, bool& valid) {
+    auto bytes = static_cast<std::uint64_t>(count) * sizeof(T);
+    if (!valid || offset + bytes > data.size()) {
+        valid = false;
+        return {};
+    }
+
+    auto result = std::span<const T>(reinterpret_cast<const T*>(data.data() + offset), count);
+    offset += bytes;
+    return result;
+}
+
+bool isValidEntry(const PaletteEntry& entry) {
+    return entry.type <= static_cast<std::uint8_t>(TileType::Void) && entry.orientation <= static_cast<std::uint8_t>(TileOrientation::None) &&
+           entry.texture <= static_cast<std::uint8_t>(TextureType::Texture2);
+}
+
+}  // namespace
+
+PaletteEntry PackTile(const Tile& tile) {
+    return PaletteEntry{static_cast<std::uint8_t>(tile.type),
+                        static_cast<std::uint8_t>(tile.orientation),
+                        static_cast<std::uint8_t>(tile.texture),
+                        0,
+                        {tile.color.r, tile.color.g, tile.color.b}};
+}
+
+Tile UnpackTile(const PaletteEntry& entry) {
+    return Tile{static_cast<TileType>(entry.type), static_cast<TileOrientation>(entry.orientation), static_cast<TextureType>(entry.texture),
+                glm::vec3(entry.color[0], entry.color[1], entry.color[2])};
+}
+
+std::vector<std::byte> Encode(Header header, const TilesVec& tiles, std::span<const RoomEntry> rooms, const RegionsVec& regions) {
+    auto palette = std::vector<PaletteEntry>();
+    auto paletteIndices = std::map<PaletteKey, std::uint32_t>();
+    auto getIndex = [&](const Tile& tile) {
+        auto entry = PackTile(tile);
+        auto [it, inserted] = paletteIndices.try_emplace(paletteKey(entry), static_cast<std::uint32_t>(palette.size()));
+        if (inserted) {
+            palette.push_back(entry);
+        }
+        return it->second;
+    };
+    // most of the tiles are equal to the previous one, so palette lookup can be skipped for them
+    auto previousKey = PaletteKey();
+    auto previousIndex = std::uint32_t(-1);
+
+    const auto& dimensions = tiles.GetDimensions();
+
+    auto runs = std::vector<Run>();
+    for (size_t x = 0; x < dimensions.width; ++x) {
+        for (size_t y = 0; y < dimensions.height; ++y) {
+            for (size_t z = 0; z < dimensions.length; ++z) {
+                const auto& tile = tiles.Get(x, y, z);
+                auto key = paletteKey(PackTile(tile));
+                auto index = key == previousKey && !runs.empty() ? previousIndex : getIndex(tile);
+                previousKey = key;
+                previousIndex = index;
+
+                if (!runs.empty() && runs.back().paletteIndex == index) {
+                    ++runs.back().length;
+                } else {
+                    runs.push_back(Run{1, index});
+                }
+            }
+        }
+    }
+
+    LOG_ASSERT(AsIVec3(regions.GetDimensions()) == AsIVec3(dimensions));
+    auto regionRuns = std::vector<RegionRun>();
+    for (size_t x = 0; x < dimensions.width; ++x) {
+        for (size_t y = 0; y < dimensions.height; ++y) {
+            for (size_t z = 0; z < dimensions.length; ++z) {
+                auto region = static_cast<std::uint32_t>(regions.Get(x, y, z));
+                if (!regionRuns.empty() && regionRuns.back().region == region) {
+                    ++regionRuns.back().length;
+                } else {
+                    regionRuns.push_back(RegionRun{1, region});
+                }
+            }
+        }
+    }
+
+    auto borderCells = std::vector<BorderCell>();
+    tiles.ForEachBorderElement([&](const glm::ivec3& coords, const Tile& tile) {
+        if (tile.type != TileType::Void) {
+            borderCells.push_back(BorderCell{{coords.x, coords.y, coords.z}, getIndex(tile)});
+        }
+    });
+
+    header.magic = magic;
+    header.version = version;
+    header.width = static_cast<std::uint32_t>(dimensions.width);
+    header.height = static_cast<std::uint32_t>(dimensions.height);
+    header.length = static_cast<std::uint32_t>(dimensions.length);
+    header.border = static_cast<std::uint32_t>(tiles.GetBorder());
+    header.paletteSize = static_cast<std::uint32_t>(palette.size());
+    header.runCount = static_cast<std::uint32_t>(runs.size());
+    header.borderCellCount = static_cast<std::uint32_t>(borderCells.size());
+    header.roomCount = static_cast<std::uint32_t>(rooms.size());
+    header.regionRunCount = static_cast<std::uint32_t>(regionRuns.size());
+
+    auto bytes = std::vector<std::byte>();
+    bytes.reserve(sizeof(Header) + palette.size() * sizeof(PaletteEntry) + runs.size() * sizeof(Run) + borderCells.size() * sizeof(BorderCell) +
+                  rooms.size() * sizeof(RoomEntry) + regionRuns.size() * sizeof(RegionRun));
+    append(bytes, &header, 1);
+    append(bytes, palette.data(), palette.size());
+    append(bytes, runs.data(), runs.size());
+    append(bytes, borderCells.data(), borderCells.size());
+    append(bytes, rooms.data(), rooms.size());
+    append(bytes, regionRuns.data(), regionRuns.size());
+
+    return bytes;
+}
+
+bool View::Init(std::span<const std::byte> data) {
+    *this = View();
+
+    if (data.size() < sizeof(Header) || reinterpret_cast<std::uintptr_t>(data.data()) % alignof(Header) != 0) {
+        return false;
+    }
+
+    const auto* h = reinterpret_cast<const Header*>(data.data());
+    if (h->magic != magic || h->version != version) {
+        return false;
+    }
+    if (h->width > maxSize || h->height > maxSize || h->length > maxSize || h->border > maxBorder) {
+        return false;
+    }
+    auto volume = static_cast<std::uint64_t>(h->width) * h->height * h->length;
+    // every corridor has at least one tile
+    if (volume > maxVolume || h->corridorCount > volume) {
+        return false;
+    }
+
+    auto valid = true;
+    auto offset = sizeof(Header);
+    auto newPalette = takeArray<PaletteEntry>(data, offset, h->paletteSize, valid);
+    auto newRuns = takeArray<Run>(data, offset, h->runCount, valid);
+    auto newBorderCells = takeArray<BorderCell>(data, offset, h->borderCellCount, valid);
+    auto newRooms = takeArray<RoomEntry>(data, offset, h->roomCount, valid);
+    auto newRegionRuns = takeArray<RegionRun>(data, offset, h->regionRunCount, valid);
+    if (!valid || offset != data.size()) {
+        return false;
+    }
+
+    for (const auto& entry : newPalette) {
+        if (!isValidEntry(entry)) {
+            return false;
+        }
+    }
+
+    auto tileCount = std::uint64_t(0);
+    for (const auto& run : newRuns) {
+        if (run.paletteIndex >= h->paletteSize) {
+            return false;
+        }
+        tileCount += run.length;
+    }
+    if (tileCount != volume) {
+        return false;
+    }
+
+    auto border = static_cast<std::int64_t>(h->border);
+    auto inBorder = [&](std::int32_t coord, std::uint32_t size) { return coord >= -border && coord < static_cast<std::int64_t>(size) + border; };
+    for (const auto& cell : newBorderCells) {
+        if (cell.paletteIndex >= h->paletteSize || !inBorder(cell.coords[0], h->width) || !inBorder(cell.coords[1], h->height) ||
+            !inBorder(cell.coords[2], h->length)) {
+            return false;
+        }
+    }
+
+    // rooms are inside of the grid, and big enough to have walls around the air (see GetRoomShape)
+    auto inGrid = [](std::int32_t offset, std::uint32_t size, std::uint32_t gridSize) {
+        return offset >= 0 && size >= 3 && static_cast<std::int64_t>(offset) + size <= gridSize;
+    };
+    for (const auto& room : newRooms) {
+        if (room.type > static_cast<std::uint32_t>(RoomType::Ellipsoid) || !inGrid(room.offset[0], room.size[0], h->width) ||
+            !inGrid(room.offset[1], room.size[1], h->height) || !inGrid(room.offset[2], room.size[2], h->length) || room.size[2] > MaxRoomLength()) {
+            return false;
+        }
+    }
+
+    auto regionCount = static_cast<std::uint64_t>(h->roomCount) + h->corridorCount;
+    auto regionTileCount = std::uint64_t(0);
+    for (const auto& run : newRegionRuns) {
+        if (run.region > regionCount) {
+            return false;
+        }
+        regionTileCount += run.length;
+    }
+    if (regionTileCount != volume) {
+        return false;
+    }
+
+    header = h;
+    palette = newPalette;
+    runs = newRuns;
+    borderCells = newBorderCells;
+    rooms = newRooms;
+    regionRuns = newRegionRuns;
+
+    return true;
+}
+
+const Header& View::GetHeader() const {
+    LOG_ASSERT(header != nullptr);
+    return *header;
+}
+
+std::span<const PaletteEntry> View::GetPalette() const {
+    return palette;
+}
+
+std::span<const Run> View::GetRuns() const {
+    return runs;
+}
+
+std::span<const BorderCell> View::GetBorderCells() const {
+    return borderCells;
+}
+
+std::span<const RoomEntry> View::GetRooms() const {
+    return rooms;
+}
+
+std::span<const RegionRun> View::GetRegionRuns() const {
+    return regionRuns;
+}
+
+Dimensions View::GetDimensions() const {
+    const auto& h = GetHeader();
+    return Dimensions{h.width, h.height, h.length};
+}
+
+void View::DecodeTiles(TilesVec& tiles) const {
+    const auto& dimensions = tiles.GetDimensions();
+    LOG_ASSERT(AsIVec3(dimensions) == AsIVec3(GetDimensions()) && tiles.GetBorder() == GetHeader().border);
+
+    auto decoded = std::vector<Tile>();
+    decoded.reserve(palette.size());
+    for (const auto& entry : palette) {
+        decoded.push_back(UnpackTile(entry));
+    }
+
+    auto x = size_t(0);
+    auto y = size_t(0);
+    auto z = size_t(0);
+    for (const auto& run : runs) {
+        const auto& tile = decoded[run.paletteIndex];
+        for (std::uint32_t i = 0; i < run.length; ++i) {
+            tiles.Set(x, y, z, tile);
+
+            if (++z == dimensions.length) {
+                z = 0;
+                if (++y == dimensions.height) {
+                    y = 0;
+                    ++x;
+                }
+            }
+        }
+    }
+
+    for (const auto& cell : borderCells) {
+        tiles.SetInOrOutOfBounds(glm::ivec3(cell.coords[0], cell.coords[1], cell.coords[2]), decoded[cell.paletteIndex]);
+    }
+}
+
+void View::DecodeRegions(RegionsVec& regions) const {
+    const auto& dimensions = regions.GetDimensions();
+    LOG_ASSERT(AsIVec3(dimensions) == AsIVec3(GetDimensions()));
+
+    auto x = size_t(0);
+    auto y = size_t(0);
+    auto z = size_t(0);
+    for (const auto& run : regionRuns) {
+        auto region = static_cast<RegionId>(run.region);
+        for (std::uint32_t i = 0; i < run.length; ++i) {
+            regions.Set(x, y, z, region);
+
+            if (++z == dimensions.length) {
+                z = 0;
+                if (++y == dimensions.height) {
+                    y = 0;
+                    ++x;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace DungeonFormat
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Tile.h"
+#include "WorldGrid.h"
+
+// Binary dungeon file format.
+// File consists of a Header, followed by arrays of PaletteEntry, Run, BorderCell, RoomEntry and RegionRun (sizes are stored in the header).
+// Tiles of the grid are stored as indices into the palette (list of unique tiles), run-length encoded in linear order
+// (z changes fastest, so every column is a sequence of runs). Border cells are stored only if they are not void.
+// Region map (see RegionId) is run-length encoded in the same order.
+// All structures are 4 byte aligned, so that the file can be read in place (e.g. when memory mapped).
+namespace DungeonFormat {
+
+static_assert(std::endian::native == std::endian::little, "dungeon files are little-endian");
+
+static constexpr std::array<char, 8> magic = {'3', 'D', 'R', 'L', 'V', 'L', '\0', '\0'};
+// increase when format changes
+static constexpr std::uint32_t version = 2;
+
+// limits of the grid of a valid file, so that a corrupted header can not make the loader allocate gigabytes
+static constexpr std::uint32_t maxSize = 1024;
+static constexpr std::uint64_t maxVolume = std::uint64_t(1) << 24;
+static constexpr std::uint32_t maxBorder = 16;
+
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    // dimensions of the grid (without border)
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t length;
+    std::uint32_t border;
+    std::uint32_t seed;
+    std::array<std::int32_t, 3> spawn;
+    std::uint32_t corridorCount;
+    std::uint32_t paletteSize;
+    std::uint32_t runCount;
+    std::uint32_t borderCellCount;
+    std::uint32_t roomCount;
+    std::uint32_t regionRunCount;
+};
+
+struct PaletteEntry {
+    std::uint8_t type;
+    std::uint8_t orientation;
+    std::uint8_t texture;
+    std::uint8_t padding;
+    std::array<float, 3> color;
+};
+
+struct Run {
+    std::uint32_t length;
+    std::uint32_t paletteIndex;
+};
+
+struct BorderCell {
+    std::array<std::int32_t, 3> coords;
+    std::uint32_t paletteIndex;
+};
+
+struct RoomEntry {
+    std::uint32_t type;
+    std::array<std::int32_t, 3> offset;
+    std::array<std::uint32_t, 3> size;
+};
+
+struct RegionRun {
+    std::uint32_t length;
+    std::uint32_t region;
+};
+
+static_assert(sizeof(Header) == 68);
+static_assert(sizeof(PaletteEntry) == 16);
+static_assert(sizeof(Run) == 8);
+static_assert(sizeof(BorderCell) == 16);
+static_assert(sizeof(RoomEntry) == 28);
+static_assert(sizeof(RegionRun) == 8);
+
+PaletteEntry PackTile(const Tile& tile);
+Tile UnpackTile(const PaletteEntry& entry);
+
+// Encodes tiles, rooms and regions into a file image. Header fields describing the level (seed, spawn, corridor count) are taken from
+// header, the rest of the fields (magic, version, dimensions and array sizes) are filled in.
+std::vector<std::byte> Encode(Header header, const TilesVec& tiles, std::span<const RoomEntry> rooms, const RegionsVec& regions);
+
+// Read-only view of a dungeon file in memory, does not copy the data.
+class View {
+ public:
+    View() = default;
+
+    // checks that data is a valid dungeon file (of the current version), returns false otherwise
+    // (also if the level is too big, or a room does not fit into it or has no shape)
+    bool Init(std::span<const std::byte> data);
+
+    const Header& GetHeader() const;
+    std::span<const PaletteEntry> GetPalette() const;
+    std::span<const Run> GetRuns() const;
+    std::span<const BorderCell> GetBorderCells() const;
+    std::span<const RoomEntry> GetRooms() const;
+    std::span<const RegionRun> GetRegionRuns() const;
+
+    Dimensions GetDimensions() const;
+    // decodes tiles (including border) into grid with matching dimensions and border
+    void DecodeTiles(TilesVec& tiles) const;
+    // decodes region map into grid with matching dimensions
+    void DecodeRegions(RegionsVec& regions) const;
+
+ private:
+    const Header* header = nullptr;
+    std::span<const PaletteEntry> palette;
+    std::span<const Run> runs;
+    std::span<const BorderCell> borderCells;
+    std::span<const RoomEntry> rooms;
+    std::span<const RegionRun> regionRuns;
+};
+
+}  // namespace DungeonFormat
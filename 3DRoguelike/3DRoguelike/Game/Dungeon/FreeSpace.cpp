@@ -0,0 +1,101 @@
+#include "FreeSpace.h"
+
+#include <algorithm>
+
+FreeSpace::FreeSpace(const Dimensions& dimensions_)
+    : dimensions(dimensions_),
+      occupied(Volume(dimensions), 0),
+      table((dimensions.width + 1) * (dimensions.height + 1) * (dimensions.length + 1), 0),
+      tableValid(true) {
+}
+
+void FreeSpace::Occupy(const Box& box) {
+    auto min = glm::max(box.offset, glm::ivec3(0));
+    auto max = glm::min(box.offset + AsIVec3(box.size), AsIVec3(dimensions));
+
+    for (int x = min.x; x < max.x; ++x) {
+        for (int y = min.y; y < max.y; ++y) {
+            auto row = occupied.begin() + CoordinatesToIndex(glm::ivec3(x, y, 0), dimensions);
+            std::fill(row + min.z, row + std::max(min.z, max.z), std::uint8_t(1));
+        }
+    }
+
+    tableValid = false;
+}
+
+std::uint32_t FreeSpace::Occupied(const Box& box) const {
+    updateTable();
+
+    auto x0 = box.offset.x;
+    auto y0 = box.offset.y;
+    auto z0 = box.offset.z;
+    auto x1 = x0 + static_cast<int>(box.size.width);
+    auto y1 = y0 + static_cast<int>(box.size.height);
+    auto z1 = z0 + static_cast<int>(box.size.length);
+
+    // inclusion-exclusion over the corners of the box
+    return table[tableIndex(x1, y1, z1)] - table[tableIndex(x0, y1, z1)] - table[tableIndex(x1, y0, z1)] - table[tableIndex(x1, y1, z0)] +
+           table[tableIndex(x0, y0, z1)] + table[tableIndex(x0, y1, z0)] + table[tableIndex(x1, y0, z0)] - table[tableIndex(x0, y0, z0)];
+}
+
+std::vector<glm::ivec3> FreeSpace::FreePositions(const Dimensions& size, const glm::ivec3& min, const glm::ivec3& max) const {
+    auto positions = std::vector<glm::ivec3>();
+    forEachFreePosition(size, min, max, [&](const glm::ivec3& offset) {
+        positions.push_back(offset);
+        return true;
+    });
+    return positions;
+}
+
+bool FreeSpace::HasFreePosition(const Dimensions& size, const glm::ivec3& min, const glm::ivec3& max) const {
+    auto found = false;
+    forEachFreePosition(size, min, max, [&](const glm::ivec3&) {
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+template <typename Func>
+void FreeSpace::forEachFreePosition(const Dimensions& size, const glm::ivec3& min, const glm::ivec3& max, Func func) const {
+    // dilated room must be inside of the level
+    auto first = glm::max(min, glm::ivec3(1));
+    auto last = glm::min(max, AsIVec3(dimensions) - AsIVec3(size) - 1);
+    auto dilated = FromIVec3(AsIVec3(size) + 2);
+
+    for (int x = first.x; x <= last.x; ++x) {
+        for (int y = first.y; y <= last.y; ++y) {
+            for (int z = first.z; z <= last.z; ++z) {
+                auto offset = glm::ivec3(x, y, z);
+                if (Occupied(Box{offset - 1, dilated}) == 0 && !func(offset)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void FreeSpace::updateTable() const {
+    if (tableValid) {
+        return;
+    }
+
+    auto size = AsIVec3(dimensions);
+    for (int x = 0; x < size.x; ++x) {
+        for (int y = 0; y < size.y; ++y) {
+            auto row = occupied.begin() + CoordinatesToIndex(glm::ivec3(x, y, 0), dimensions);
+            auto sum = std::uint32_t(0);
+            for (int z = 0; z < size.z; ++z) {
+                sum += row[z];
+                table[tableIndex(x + 1, y + 1, z + 1)] = sum + table[tableIndex(x, y + 1, z + 1)] + table[tableIndex(x + 1, y, z + 1)] -
+                                                         table[tableIndex(x, y, z + 1)];
+            }
+        }
+    }
+
+    tableValid = true;
+}
+
+size_t FreeSpace::tableIndex(int x, int y, int z) const {
+    return (static_cast<size_t>(x) * (dimensions.height + 1) + static_cast<size_t>(y)) * (dimensions.length + 1) + static_cast<size_t>(z);
+}
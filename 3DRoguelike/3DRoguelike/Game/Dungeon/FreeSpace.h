@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Room.h"
+#include "../Utility/Vector3D.h"
+
+// how positions of new rooms are chosen
+enum class RoomPlacement {
+    // random position in the level, rejected if the room does not fit (reproduces the canon files)
+    Rejection,
+    // random position among the ones where the room does not touch other rooms (see FreeSpace)
+    FreeSpace
+};
+
+// Tiles of the level occupied by rooms (dilated by one tile), with a summed-volume table over them,
+// so that the number of occupied tiles in any box is found with 8 lookups.
+class FreeSpace {
+ public:
+    explicit FreeSpace(const Dimensions& dimensions_ = Dimensions());
+
+    // marks tiles of the box (clipped to the level) as occupied
+    void Occupy(const Box& box);
+    // number of occupied tiles in the box, box must be inside of the level
+    std::uint32_t Occupied(const Box& box) const;
+
+    // offsets in range [min, max] (in x-major order), where the room of the given size (dilated by one tile) lies in free space
+    std::vector<glm::ivec3> FreePositions(const Dimensions& size, const glm::ivec3& min, const glm::ivec3& max) const;
+    bool HasFreePosition(const Dimensions& size, const glm::ivec3& min, const glm::ivec3& max) const;
+
+ private:
+    // calls func(offset) for free positions until it returns false
+    template <typename Func>
+    void forEachFreePosition(const Dimensions& size, const glm::ivec3& min, const glm::ivec3& max, Func func) const;
+    void updateTable() const;
+    size_t tableIndex(int x, int y, int z) const;
+
+ private:
+    Dimensions dimensions;
+    std::vector<std::uint8_t> occupied;
+
+    // table[(x, y, z)] is the number of occupied tiles with coordinates less than (x, y, z), rebuilt lazily after changes
+    mutable std::vector<std::uint32_t> table;
+    mutable bool tableValid;
+};
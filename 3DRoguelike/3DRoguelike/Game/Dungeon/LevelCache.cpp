@@ -0,0 +1,318 @@
+#include "LevelCache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Dungeon.h"
+#include "DungeonFormat.h"
+#include "../Utility/LogDuration.h"
+#include "../Utility/MappedFile.h"
+
+namespace {
+
+// render data file consists of the header, followed by chunk headers, followed by arrays of block mesh vertices, their region ranges,
+// coarse block mesh vertices, stairs instances and regions of the stairs of every chunk (sizes are stored in the chunk headers)
+static constexpr std::array<char, 8> renderDataMagic = {'3', 'D', 'R', 'L', 'I', 'N', 'S', 'T'};
+// increase when TileRenderData changes
+static constexpr std::uint32_t renderDataVersion = 8;
+
+struct RenderDataHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::array<std::int32_t, 3> origin;
+    std::array<std::int32_t, 3> chunkCounts;
+};
+
+struct ChunkHeader {
+    std::array<std::int32_t, 3> lo;
+    std::array<std::int32_t, 3> hi;
+    std::uint32_t blockVertexCount;
+    std::uint32_t blockRangeCount;
+    std::array<std::uint32_t, lodScales.size()> coarseVertexCounts;
+    std::uint32_t stairsCount;
+    std::uint32_t stairsRegionCount;
+};
+
+// RegionRange without padding
+struct RegionRangeEntry {
+    std::uint32_t region;
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+static_assert(sizeof(RenderDataHeader) == 36);
+static_assert(sizeof(ChunkHeader) == 48);
+static_assert(sizeof(RegionRangeEntry) == 12);
+static_assert(std::is_trivially_copyable_v<TileInstance> && sizeof(TileInstance) == 12);
+static_assert(std::is_trivially_copyable_v<MeshVertex> && sizeof(MeshVertex) == 12);
+
+// writes file via temporary file, so that partially written entries are never read
+void writeFile(const std::filesystem::path& path, std::span<const std::span<const std::byte>> parts) {
+    auto temporary = path;
+    temporary += ".tmp";
+
+    {
+        auto file = std::ofstream(temporary, std::ios::binary);
+        for (const auto& part : parts) {
+            file.write(reinterpret_cast<const char*>(part.data()), static_cast<std::streamsize>(part.size()));
+        }
+        if (!file) {
+            return;
+        }
+    }
+
+    auto error = std::error_code();
+    std::filesystem::rename(temporary, path, error);
+}
+
+}  // namespace
+
+std::string ToString(const LevelKey& key) {
+    const auto& d = key.dimensions;
+    auto startingRoom = key.startingRoom.has_value() ? std::to_string(key.startingRoom.value()) : std::string("r");
+    // rejection placement is not marked, so that names of the entries cached before placement modes were added stay valid
+    auto placement = key.roomPlacement == RoomPlacement::FreeSpace ? "_free" : "";
+
+    return std::to_string(key.seed) + "_" + std::to_string(d.width) + "x" + std::to_string(d.height) + "x" + std::to_string(d.length) + "_" +
+           std::to_string(key.roomCount) + "_" + (key.rngMode == RNGMode::Counter ? "counter" : "mt") + "_" + startingRoom + placement + "_v" +
+           std::to_string(generatorVersion) + "." + std::to_string(DungeonFormat::version) + "." + std::to_string(renderDataVersion);
+}
+
+LevelCache::LevelCache(std::filesystem::path directory_, std::uintmax_t sizeLimit_) : directory(std::move(directory_)), sizeLimit(sizeLimit_) {
+    auto error = std::error_code();
+    std::filesystem::create_directories(directory, error);
+}
+
+bool LevelCache::LoadLevel(const LevelKey& key, Dungeon& dungeon) {
+    LOG_DURATION("LevelCache::LoadLevel");
+
+    auto lock = std::lock_guard(mutex);
+    auto path = entryPath(key, ".lvl");
+    if (!dungeon.LoadBinary(path.string())) {
+        return false;
+    }
+
+    touch(path);
+    return true;
+}
+
+void LevelCache::StoreLevel(const LevelKey& key, const Dungeon& dungeon) {
+    LOG_DURATION("LevelCache::StoreLevel");
+
+    auto lock = std::lock_guard(mutex);
+    auto bytes = dungeon.SerializeBinary();
+    auto parts = std::array{std::span<const std::byte>(bytes)};
+    writeFile(entryPath(key, ".lvl"), parts);
+
+    evict(key);
+}
+
+std::optional<TileRenderData> LevelCache::LoadRenderData(const LevelKey& key) {
+    LOG_DURATION("LevelCache::LoadRenderData");
+
+    auto lock = std::lock_guard(mutex);
+    auto path = entryPath(key, ".inst");
+
+    auto file = util::MappedFile();
+    if (!file.Open(path.string())) {
+        return std::nullopt;
+    }
+
+    auto bytes = file.GetData();
+    if (bytes.size() < sizeof(RenderDataHeader)) {
+        return std::nullopt;
+    }
+
+    auto header = RenderDataHeader();
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != renderDataMagic || header.version != renderDataVersion) {
+        return std::nullopt;
+    }
+
+    // number of chunks is checked before it is multiplied, so that it does not overflow
+    auto maxChunkCount = (bytes.size() - sizeof(RenderDataHeader)) / sizeof(ChunkHeader);
+    auto chunkCount = std::uint64_t(1);
+    for (auto count : header.chunkCounts) {
+        if (count < 0 || (count != 0 && chunkCount > maxChunkCount / static_cast<std::uint64_t>(count))) {
+            return std::nullopt;
+        }
+        chunkCount *= static_cast<std::uint64_t>(count);
+    }
+
+    auto chunkHeaders = std::vector<ChunkHeader>(chunkCount);
+    std::memcpy(chunkHeaders.data(), bytes.data() + sizeof(RenderDataHeader), chunkCount * sizeof(ChunkHeader));
+
+    auto size = sizeof(RenderDataHeader) + chunkCount * sizeof(ChunkHeader);
+    for (const auto& chunkHeader : chunkHeaders) {
+        size += chunkHeader.blockVertexCount * sizeof(MeshVertex) + chunkHeader.blockRangeCount * sizeof(RegionRangeEntry);
+        for (auto count : chunkHeader.coarseVertexCounts) {
+            size += count * sizeof(MeshVertex);
+        }
+        size += chunkHeader.stairsCount * sizeof(TileInstance) + chunkHeader.stairsRegionCount * sizeof(RegionId);
+        if (size > bytes.size()) {
+            return std::nullopt;
+        }
+    }
+    if (bytes.size() != size) {
+        return std::nullopt;
+    }
+
+    auto offset = sizeof(RenderDataHeader) + chunkCount * sizeof(ChunkHeader);
+    auto read = [&]<typename T>(std::vector<T>& elements, std::uint32_t count) {
+        elements.resize(count);
+        std::memcpy(elements.data(), bytes.data() + offset, count * sizeof(T));
+        offset += count * sizeof(T);
+    };
+    auto toIVec3 = [](const std::array<std::int32_t, 3>& v) { return glm::ivec3(v[0], v[1], v[2]); };
+
+    auto data = TileRenderData();
+    data.origin = toIVec3(header.origin);
+    data.chunkCounts = toIVec3(header.chunkCounts);
+    data.chunks.reserve(chunkCount);
+    for (const auto& chunkHeader : chunkHeaders) {
+        auto& chunk = data.chunks.emplace_back(ChunkRenderData{toIVec3(chunkHeader.lo), toIVec3(chunkHeader.hi), {}, {}, {}, {}, {}});
+        read(chunk.blocks, chunkHeader.blockVertexCount);
+
+        auto ranges = std::vector<RegionRangeEntry>();
+        read(ranges, chunkHeader.blockRangeCount);
+        for (const auto& range : ranges) {
+            // ranges are used for drawing, so they must not point outside of the vertices
+            if (range.region > std::numeric_limits<RegionId>::max() || std::uint64_t(range.first) + range.count > chunk.blocks.size()) {
+                return std::nullopt;
+            }
+            chunk.blockRanges.push_back({static_cast<RegionId>(range.region), range.first, range.count});
+        }
+
+        for (size_t i = 0; i < chunk.coarseBlocks.size(); ++i) {
+            read(chunk.coarseBlocks[i], chunkHeader.coarseVertexCounts[i]);
+        }
+        // axis selects the texture coordinates in the vertex shader
+        auto isValidVertex = [](const MeshVertex& vertex) { return vertex.axis >= 0 && vertex.axis < 3; };
+        auto areValidVertices = [&](const std::vector<MeshVertex>& vertices) { return std::all_of(vertices.begin(), vertices.end(), isValidVertex); };
+        if (!areValidVertices(chunk.blocks) || !std::all_of(chunk.coarseBlocks.begin(), chunk.coarseBlocks.end(), areValidVertices)) {
+            return std::nullopt;
+        }
+
+        read(chunk.stairs, chunkHeader.stairsCount);
+        // orientation selects the rotation in the vertex shader
+        auto isValid = [](const TileInstance& stairs) { return stairs.orientation >= 0 && stairs.orientation < 4; };
+        if (!std::all_of(chunk.stairs.begin(), chunk.stairs.end(), isValid)) {
+            return std::nullopt;
+        }
+        read(chunk.stairsRegions, chunkHeader.stairsRegionCount);
+    }
+
+    touch(path);
+    return data;
+}
+
+void LevelCache::StoreRenderData(const LevelKey& key, const TileRenderData& data) {
+    LOG_DURATION("LevelCache::StoreRenderData");
+
+    auto lock = std::lock_guard(mutex);
+    auto toArray = [](const glm::ivec3& v) { return std::array{v.x, v.y, v.z}; };
+
+    auto header = RenderDataHeader{renderDataMagic, renderDataVersion, toArray(data.origin), toArray(data.chunkCounts)};
+    auto chunkHeaders = std::vector<ChunkHeader>();
+    auto chunkRanges = std::vector<std::vector<RegionRangeEntry>>();
+    for (const auto& chunk : data.chunks) {
+        auto& chunkHeader = chunkHeaders.emplace_back(ChunkHeader{toArray(chunk.lo), toArray(chunk.hi), 0, 0, {}, 0, 0});
+        chunkHeader.blockVertexCount = static_cast<std::uint32_t>(chunk.blocks.size());
+        chunkHeader.blockRangeCount = static_cast<std::uint32_t>(chunk.blockRanges.size());
+        for (size_t i = 0; i < chunk.coarseBlocks.size(); ++i) {
+            chunkHeader.coarseVertexCounts[i] = static_cast<std::uint32_t>(chunk.coarseBlocks[i].size());
+        }
+        chunkHeader.stairsCount = static_cast<std::uint32_t>(chunk.stairs.size());
+        chunkHeader.stairsRegionCount = static_cast<std::uint32_t>(chunk.stairsRegions.size());
+
+        auto& ranges = chunkRanges.emplace_back();
+        for (const auto& range : chunk.blockRanges) {
+            ranges.push_back({range.region, range.first, range.count});
+        }
+    }
+
+    auto parts = std::vector<std::span<const std::byte>>();
+    parts.push_back(std::as_bytes(std::span(&header, 1)));
+    parts.push_back(std::as_bytes(std::span(chunkHeaders)));
+    for (size_t i = 0; i < data.chunks.size(); ++i) {
+        const auto& chunk = data.chunks[i];
+        parts.push_back(std::as_bytes(std::span(chunk.blocks)));
+        parts.push_back(std::as_bytes(std::span(chunkRanges[i])));
+        for (const auto& vertices : chunk.coarseBlocks) {
+            parts.push_back(std::as_bytes(std::span(vertices)));
+        }
+        parts.push_back(std::as_bytes(std::span(chunk.stairs)));
+        parts.push_back(std::as_bytes(std::span(chunk.stairsRegions)));
+    }
+    writeFile(entryPath(key, ".inst"), parts);
+
+    evict(key);
+}
+
+std::filesystem::path LevelCache::entryPath(const LevelKey& key, const char* extension) const {
+    return directory / (ToString(key) + extension);
+}
+
+void LevelCache::touch(const std::filesystem::path& path) {
+    auto error = std::error_code();
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+}
+
+void LevelCache::evict(const LevelKey& key) {
+    struct Entry {
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type lastUsed = std::filesystem::file_time_type::min();
+    };
+
+    // files of an entry have the same name (stem) and different extensions
+    auto entries = std::map<std::string, Entry>();
+    auto totalSize = std::uintmax_t(0);
+
+    auto error = std::error_code();
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        auto extension = file.path().extension();
+        if (!file.is_regular_file(error) || (extension != ".lvl" && extension != ".inst")) {
+            continue;
+        }
+
+        auto size = file.file_size(error);
+        if (error) {
+            continue;
+        }
+
+        auto& entry = entries[file.path().stem().string()];
+        entry.size += size;
+        entry.lastUsed = std::max(entry.lastUsed, file.last_write_time(error));
+        totalSize += size;
+    }
+
+    if (totalSize <= sizeLimit) {
+        return;
+    }
+
+    entries.erase(ToString(key));
+
+    auto order = std::vector<std::pair<std::filesystem::file_time_type, std::string>>();
+    for (const auto& [name, entry] : entries) {
+        order.emplace_back(entry.lastUsed, name);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (const auto& [lastUsed, name] : order) {
+        if (totalSize <= sizeLimit) {
+            break;
+        }
+
+        std::filesystem::remove(directory / (name + ".lvl"), error);
+        std::filesystem::remove(directory / (name + ".inst"), error);
+        totalSize -= entries[name].size;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "FreeSpace.h"
+#include "TileRenderData.h"
+#include "WorldGrid.h"
+#include "../Utility/Random.h"
+
+class Dungeon;
+
+// increase when generator output changes, so that levels cached by the older generator are not used
+static constexpr std::uint32_t generatorVersion = 1;
+
+// parameters that determine generated level
+struct LevelKey {
+    SeedType seed = 0;
+    Dimensions dimensions = Dimensions();
+    size_t roomCount = 0;
+    RNGMode rngMode = RNGMode::MersenneTwister;
+    std::optional<size_t> startingRoom = std::nullopt;
+    RoomPlacement roomPlacement = RoomPlacement::Rejection;
+};
+
+// file name of the cache entry, includes generator and file format versions
+std::string ToString(const LevelKey& key);
+
+// On-disk cache of generated levels.
+// Every entry consists of the level in binary format (<key>.lvl, see DungeonFormat.h) and optionally
+// prebuilt render data (<key>.inst, see TileRenderData.h). Least recently used entries are evicted when total size of the cache exceeds the limit.
+// Cache can be used from several threads (the game and the background generator), accesses are serialized.
+class LevelCache {
+ public:
+    LevelCache(std::filesystem::path directory_, std::uintmax_t sizeLimit_);
+
+    // loads cached level into dungeon, returns false if level is not cached
+    bool LoadLevel(const LevelKey& key, Dungeon& dungeon);
+    void StoreLevel(const LevelKey& key, const Dungeon& dungeon);
+
+    std::optional<TileRenderData> LoadRenderData(const LevelKey& key);
+    void StoreRenderData(const LevelKey& key, const TileRenderData& data);
+
+ private:
+    std::filesystem::path entryPath(const LevelKey& key, const char* extension) const;
+    // marks entry as recently used
+    void touch(const std::filesystem::path& path);
+    // removes least recently used entries (except of the key) until cache fits into the size limit
+    void evict(const LevelKey& key);
+
+ private:
+    std::filesystem::path directory;
+    std::uintmax_t sizeLimit;
+
+    // entries are written via the same temporary files and evicted by scanning the whole directory
+    std::mutex mutex;
+};
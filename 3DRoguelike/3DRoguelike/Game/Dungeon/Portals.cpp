@@ -0,0 +1,213 @@
+#include "Portals.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <utility>
+
+#include "../Assert.h"
+
+namespace {
+
+// face between the adjacent tiles
+std::pair<glm::vec3, glm::vec3> faceBox(const glm::ivec3& coords1, const glm::ivec3& coords2) {
+    auto min = glm::vec3(glm::min(coords1, coords2)) - 0.5f;
+    auto max = glm::vec3(glm::max(coords1, coords2)) + 0.5f;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (coords1[axis] != coords2[axis]) {
+            min[axis] += 1.0f;
+            max[axis] -= 1.0f;
+        }
+    }
+    return {min, max};
+}
+
+// expands the portal by the face if the face is at most one tile apart from it
+bool mergeFace(Portal& portal, const glm::vec3& min, const glm::vec3& max) {
+    if (!glm::all(glm::lessThanEqual(portal.min - 1.0f, max)) || !glm::all(glm::lessThanEqual(min, portal.max + 1.0f))) {
+        return false;
+    }
+    portal.min = glm::min(portal.min, min);
+    portal.max = glm::max(portal.max, max);
+    return true;
+}
+
+}  // namespace
+
+RegionId CellOfTile(const Tile& tile, const RegionsVec& regions, const glm::ivec3& coords) {
+    if (tile.type == TileType::Void || !IsInBounds(coords, regions.GetDimensions())) {
+        return 0;
+    }
+    return regions.Get(coords);
+}
+
+std::vector<Portal> FindPortals(const TilesVec& tiles, const RegionsVec& regions) {
+    const auto& dimensions = tiles.GetDimensions();
+    auto size = AsIVec3(dimensions);
+
+    auto portals = std::vector<Portal>();
+    // indices of the portals between every pair of regions
+    auto pairPortals = std::map<std::pair<RegionId, RegionId>, std::vector<size_t>>();
+
+    auto addFace = [&](RegionId region1, RegionId region2, const glm::vec3& min, const glm::vec3& max) {
+        auto& indices = pairPortals[std::minmax(region1, region2)];
+        for (auto index : indices) {
+            if (mergeFace(portals[index], min, max)) {
+                return;
+            }
+        }
+        indices.push_back(portals.size());
+        portals.push_back(Portal{{std::min(region1, region2), std::max(region1, region2)}, min, max});
+    };
+
+    // cells of the tiles in x-major order (-1 for solid blocks), so that neighbours are found with strides
+    auto cells = std::vector<std::int32_t>(Volume(dimensions));
+    auto cell = cells.begin();
+    for (int x = 0; x < size.x; ++x) {
+        for (int y = 0; y < size.y; ++y) {
+            for (int z = 0; z < size.z; ++z, ++cell) {
+                auto coords = glm::ivec3(x, y, z);
+                const auto& tile = tiles.Get(coords);
+                *cell = IsSolidBlock(tile.type) ? -1 : CellOfTile(tile, regions, coords);
+            }
+        }
+    }
+
+    auto strides = std::array{static_cast<size_t>(size.y) * size.z, static_cast<size_t>(size.z), size_t(1)};
+    auto index = size_t(0);
+    for (int x = 0; x < size.x; ++x) {
+        for (int y = 0; y < size.y; ++y) {
+            for (int z = 0; z < size.z; ++z, ++index) {
+                auto coords = glm::ivec3(x, y, z);
+                if (cells[index] < 0) {
+                    continue;
+                }
+
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (coords[axis] + 1 == size[axis]) {
+                        continue;
+                    }
+
+                    auto adjacentCell = cells[index + strides[axis]];
+                    if (adjacentCell < 0 || adjacentCell == cells[index]) {
+                        continue;
+                    }
+
+                    auto adjacentCoords = coords;
+                    ++adjacentCoords[axis];
+                    auto [min, max] = faceBox(coords, adjacentCoords);
+                    addFace(static_cast<RegionId>(cells[index]), static_cast<RegionId>(adjacentCell), min, max);
+                }
+            }
+        }
+    }
+
+    return portals;
+}
+
+void AddPortalFace(std::vector<Portal>& portals, RegionId cell1, const glm::ivec3& coords1, RegionId cell2, const glm::ivec3& coords2) {
+    LOG_ASSERT(cell1 != cell2);
+    auto regions = std::array{std::min(cell1, cell2), std::max(cell1, cell2)};
+    auto [min, max] = faceBox(coords1, coords2);
+
+    for (auto& portal : portals) {
+        if (portal.regions == regions && mergeFace(portal, min, max)) {
+            return;
+        }
+    }
+    portals.push_back(Portal{regions, min, max});
+}
+
+PortalGraph::PortalGraph(std::vector<Portal> portals_, size_t regionCount) : portals(std::move(portals_)), regionPortals(regionCount) {
+    for (size_t i = 0; i < portals.size(); ++i) {
+        for (auto region : portals[i].regions) {
+            LOG_ASSERT(region < regionCount);
+            regionPortals[region].push_back(i);
+        }
+    }
+}
+
+void PortalGraph::FindVisibleRegions(RegionId cameraRegion, const glm::mat4& projectionView, std::vector<bool>& visible) const {
+    LOG_ASSERT(cameraRegion < regionPortals.size());
+    visible.assign(regionPortals.size(), false);
+
+    // screen rectangles through which the regions are seen, a region is walked again only if its rectangle grows,
+    // rectangles are built from a finite set of coordinates, so the walk ends even if the graph has cycles
+    auto rects = std::vector<std::optional<Rect>>(regionPortals.size());
+    auto stack = std::vector<std::pair<RegionId, Rect>>();
+
+    rects[cameraRegion] = Rect{glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, 1.0f)};
+    visible[cameraRegion] = true;
+    stack.push_back({cameraRegion, rects[cameraRegion].value()});
+
+    while (!stack.empty()) {
+        auto [region, rect] = stack.back();
+        stack.pop_back();
+
+        for (auto index : regionPortals[region]) {
+            const auto& portal = portals[index];
+            auto next = portal.regions[0] == region ? portal.regions[1] : portal.regions[0];
+
+            auto portalRect = clip(portal, projectionView, rect);
+            if (!portalRect.has_value()) {
+                continue;
+            }
+
+            auto& nextRect = rects[next];
+            if (nextRect.has_value()) {
+                auto grown = Rect{glm::vec2(std::min(nextRect->min.x, portalRect->min.x), std::min(nextRect->min.y, portalRect->min.y)),
+                                  glm::vec2(std::max(nextRect->max.x, portalRect->max.x), std::max(nextRect->max.y, portalRect->max.y))};
+                if (grown.min == nextRect->min && grown.max == nextRect->max) {
+                    continue;
+                }
+                nextRect = grown;
+            } else {
+                nextRect = portalRect;
+            }
+
+            visible[next] = true;
+            stack.push_back({next, portalRect.value()});
+        }
+    }
+}
+
+size_t PortalGraph::GetRegionCount() const {
+    return regionPortals.size();
+}
+
+std::optional<PortalGraph::Rect> PortalGraph::clip(const Portal& portal, const glm::mat4& projectionView, const Rect& rect) {
+    static constexpr auto infinity = std::numeric_limits<float>::infinity();
+    auto portalRect = Rect{glm::vec2(infinity, infinity), glm::vec2(-infinity, -infinity)};
+    auto behind = 0;
+    for (int corner = 0; corner < 8; ++corner) {
+        auto position = glm::vec3(corner & 1 ? portal.max.x : portal.min.x, corner & 2 ? portal.max.y : portal.min.y,
+                                  corner & 4 ? portal.max.z : portal.min.z);
+        auto clipPosition = projectionView * glm::vec4(position, 1.0f);
+        // corners behind the camera do not have a screen position
+        if (clipPosition.w <= 1e-3f) {
+            ++behind;
+            continue;
+        }
+
+        auto screen = glm::vec2(clipPosition.x / clipPosition.w, clipPosition.y / clipPosition.w);
+        portalRect.min = glm::vec2(std::min(portalRect.min.x, screen.x), std::min(portalRect.min.y, screen.y));
+        portalRect.max = glm::vec2(std::max(portalRect.max.x, screen.x), std::max(portalRect.max.y, screen.y));
+    }
+
+    if (behind == 8) {
+        return std::nullopt;
+    }
+    // portal crosses the plane of the camera, it can cover any part of the screen
+    if (behind > 0) {
+        return rect;
+    }
+
+    portalRect.min = glm::vec2(std::max(portalRect.min.x, rect.min.x), std::max(portalRect.min.y, rect.min.y));
+    portalRect.max = glm::vec2(std::min(portalRect.max.x, rect.max.x), std::min(portalRect.max.y, rect.max.y));
+    if (portalRect.min.x >= portalRect.max.x || portalRect.min.y >= portalRect.max.y) {
+        return std::nullopt;
+    }
+    return portalRect;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "WorldGrid.h"
+
+// Opening between two regions (the cells of the portal graph): faces where non-solid tiles of the regions touch.
+// Region 0 (tiles outside of rooms and corridors) is a cell too, it contains the outer sides of the walls.
+struct Portal {
+    std::array<RegionId, 2> regions = {};
+    // bounding box of the faces
+    glm::vec3 min = glm::vec3();
+    glm::vec3 max = glm::vec3();
+};
+
+// Cell of a tile that is not a solid block: its region, except for void tiles, which are outside even inside of the bounding box of a room,
+// tiles out of bounds are outside too.
+RegionId CellOfTile(const Tile& tile, const RegionsVec& regions, const glm::ivec3& coords);
+
+// faces between the same regions are merged into one portal when they are at most one tile apart
+std::vector<Portal> FindPortals(const TilesVec& tiles, const RegionsVec& regions);
+// adds the face between adjacent tiles of different cells (after a tile was changed), merging it in the same way as FindPortals
+void AddPortalFace(std::vector<Portal>& portals, RegionId cell1, const glm::ivec3& coords1, RegionId cell2, const glm::ivec3& coords2);
+
+// Portal graph of a level, finds regions that can be seen from the region of the camera.
+// Regions are walked through the portals, the visible part of the screen is narrowed to the screen rectangle of every passed portal.
+class PortalGraph {
+ public:
+    PortalGraph() = default;
+    PortalGraph(std::vector<Portal> portals_, size_t regionCount);
+
+    // visible[region] is set for regions that can be seen through the portals (conservatively), regions are not culled by the frustum
+    void FindVisibleRegions(RegionId cameraRegion, const glm::mat4& projectionView, std::vector<bool>& visible) const;
+
+    size_t GetRegionCount() const;
+
+ private:
+    // part of the screen in normalized device coordinates
+    struct Rect {
+        glm::vec2 min;
+        glm::vec2 max;
+    };
+
+    // screen rectangle of the portal clipped to the rectangle, empty if the portal is not visible through it
+    static std::optional<Rect> clip(const Portal& portal, const glm::mat4& projectionView, const Rect& rect);
+
+ private:
+    std::vector<Portal> portals;
+    // indices of the portals of every region
+    std::vector<std::vector<size_t>> regionPortals;
+};
@@ -2,52 +2,51 @@
 
 #include <algorithm>
 #include <array>
-#include <unordered_set>
+#include <bit>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <utility>
 
 #include <glm/gtx/std_based_type.hpp>
 
-void IRoom::Place(TilesVec& dungeon) const {
-    auto dimensions = dungeon.GetDimensions();
-    LOG_ASSERT(BoxFitsIntoBox(Box{offset, size}, Box{{0, 0, 0}, dimensions}));
+namespace {
 
-    for (size_t i = 0; i < size.width; ++i) {
-        for (size_t j = 0; j < size.height; ++j) {
-            for (size_t k = 0; k < size.length; ++k) {
-                const auto& tile = tiles.Get(i, j, k);
+// fills runs of set bits of the row with the tile
+void fillRow(TilesVec& dungeon, glm::ivec3 start, std::uint64_t row, const Tile& tile) {
+    while (row != 0) {
+        auto skip = std::countr_zero(row);
+        row >>= skip;
+        start.z += skip;
 
-                if (tile.type != TileType::Void) {
-                    dungeon.Set(offset.x + i, offset.y + j, offset.z + k, tile);
-                }
-            }
-        }
+        auto run = std::countr_one(row);
+        dungeon.FillRow(start, run, tile);
+        row = run < 64 ? row >> run : 0;
+        start.z += run;
     }
 }
 
-const std::vector<glm::ivec3>& IRoom::GetEdgeTiles() const {
-    return edgeTiles;
-}
+}  // namespace
 
-const std::unordered_set<glm::ivec3>& IRoom::GetIntersectionTiles() {
-    if (intersectionTiles.empty()) {
-        for (int i = 0; i < size.width; ++i) {
-            for (int j = 0; j < size.height; ++j) {
-                for (int k = 0; k < size.length; ++k) {
-                    auto coords = glm::ivec3(i, j, k);
-                    if (tiles.Get(coords).type == TileType::Void) {
-                        continue;
-                    }
-
-                    intersectionTiles.insert(coords);
-                    for (const auto& neighbour : GetNeighbours(coords)) {
-                        intersectionTiles.insert(neighbour);
-                    }
-                }
-            }
+void Room::Place(TilesVec& dungeon) const {
+    auto dimensions = dungeon.GetDimensions();
+    LOG_ASSERT(BoxFitsIntoBox(Box{offset, size}, Box{{0, 0, 0}, dimensions}));
+
+    auto air = Tile{TileType::Air, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
+    auto wall = Tile{TileType::Block, TileOrientation::None, TextureType::Texture1, wallColor};
+
+    // void tiles are skipped, air and wall tiles are written as contiguous spans of z-rows
+    for (size_t i = 0; i < size.width; ++i) {
+        for (size_t j = 0; j < size.height; ++j) {
+            auto start = offset + glm::ivec3(i, j, 0);
+            fillRow(dungeon, start, shape->airRows[i * size.height + j], air);
+            fillRow(dungeon, start, shape->wallRows[i * size.height + j], wall);
         }
     }
+}
 
-    return intersectionTiles;
+const std::vector<glm::ivec3>& Room::GetEdgeTiles() const {
+    return shape->edgeTiles;
 }
 
 bool BoxFitsIntoBox(const Box& box1, const Box& box2) {
@@ -74,19 +73,31 @@ bool PointInsideBox(const glm::ivec3& coords, const Box& box) {
            coords.y < (box.offset.y + box.size.height) && coords.z >= box.offset.z && coords.z < (box.offset.z + box.size.length);
 }
 
+Dimensions MinRoomSize() {
+    // see randomRoomSize, ellipsoid rooms are bigger
+    return Dimensions{9, 6, 9};
+}
+
+size_t MaxRoomLength() {
+    return 64 - 2;
+}
+
 bool RoomsIntersect(const Room& r1, const Room& r2) {
-    auto [min, max] = getMinMaxHelper(Box{r1->offset - 1, FromIVec3(AsIVec3(r1->size) + 2)}, Box{r2->offset - 1, FromIVec3(AsIVec3(r2->size) + 2)});
+    auto [min, max] = getMinMaxHelper(Box{r1.offset - 1, FromIVec3(AsIVec3(r1.size) + 2)}, Box{r2.offset - 1, FromIVec3(AsIVec3(r2.size) + 2)});
     if (max.x > min.x || max.y > min.y || max.z > min.z) {
         return false;
     }
 
-    const auto& s1 = r1->GetIntersectionTiles();
-    const auto& s2 = r2->GetIntersectionTiles();
-
-    // check if sets intersect
-    for (const auto& tile : s1) {
-        if (s2.contains(tile)) {
-            return true;
+    // intersection tiles are compared in room coordinates (offsets of the rooms are not taken into account)
+    const auto& s1 = *r1.shape;
+    const auto& s2 = *r2.shape;
+    auto width = std::min(r1.size.width, r2.size.width) + 2;
+    auto height = std::min(r1.size.height, r2.size.height) + 2;
+    for (size_t x = 0; x < width; ++x) {
+        for (size_t y = 0; y < height; ++y) {
+            if (s1.intersectionRows[x * (r1.size.height + 2) + y] & s2.intersectionRows[x * (r2.size.height + 2) + y]) {
+                return true;
+            }
         }
     }
 
@@ -94,53 +105,86 @@ bool RoomsIntersect(const Room& r1, const Room& r2) {
 }
 
 glm::vec3 RoomCenter(const Room& room) {
-    return glm::vec3(room->offset) + 0.5f * glm::vec3(room->size.width, room->size.height, room->size.length);
+    return glm::vec3(room.offset) + 0.5f * glm::vec3(room.size.width, room.size.height, room.size.length);
 }
 glm::ivec3 RoomCenterCoords(const Room& room) {
-    return room->offset + AsIVec3(room->size) / 2;
+    return room.offset + AsIVec3(room.size) / 2;
 }
 
-// room generation code
+// room shapes
 
-// rect room
+namespace {
 
-void RectRoom::Generate(RNG& rng, SeedType seed) {
-    auto width = rng.IntUniform<size_t>(9, 18);
-    auto height = rng.IntUniform<size_t>(6, 8);
-    auto length = rng.IntUniform<size_t>(9, 18);
-    size = Dimensions{width, height, length};
-    tiles = TilesVec(size, Tile{TileType::Void, TileOrientation::None, TextureType::None, glm::vec3(1.0f)});
+template <typename T>
+using Vector2D = std::vector<std::vector<T>>;
 
-    auto air = Tile{TileType::Air, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
-    auto wall = Tile{TileType::Block, TileOrientation::None, TextureType::Texture1,
-                     glm::vec3(rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f))};
+// Shapes are built from z-rows of tiles: bit k of row (x, y) is set for tile (x, y, k).
+// Erosion and neighbour checks work on whole rows with bitwise operations.
+using Row = std::uint64_t;
+using Rows = Vector2D<Row>;
 
-    for (size_t i = 1; i < width - 1; ++i) {
-        for (size_t j = 1; j < height - 1; ++j) {
-            for (size_t k = 1; k < length - 1; ++k) {
-                tiles.Set(i, j, k, air);
-            }
-        }
+// bits first..last - 1
+Row bitRange(size_t first, size_t last) {
+    return last - first >= 64 ? ~Row(0) << first : ((Row(1) << (last - first)) - 1) << first;
+}
+
+template <typename Func>
+void forEachBit(Row row, Func func) {
+    for (; row != 0; row &= row - 1) {
+        func(static_cast<size_t>(std::countr_zero(row)));
     }
+}
 
-    for (size_t i = 0; i < width; ++i)
-        for (size_t k = 0; k < length; ++k) {
-            tiles.Set(i, 0, k, wall);
-            tiles.Set(i, height - 1, k, wall);
-        }
-    for (size_t j = 1; j < height - 1; ++j)
-        for (size_t k = 0; k < length; ++k) {
-            tiles.Set(0, j, k, wall);
-            tiles.Set(width - 1, j, k, wall);
-        }
-    for (size_t i = 1; i < width - 1; ++i)
-        for (size_t j = 1; j < height - 1; ++j) {
-            tiles.Set(i, j, 0, wall);
-            tiles.Set(i, j, length - 1, wall);
+// Squared normalized coordinates (2 * (x + 0.5) / size - 1)^2 for x in offset..offset + count - 1.
+// The difference is computed in float and squared in double, the same as std::pow(float, int) does.
+std::vector<double> squaredCoordinates(size_t count, size_t size, size_t offset = 0) {
+    auto squares = std::vector<double>(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto t = 2.0f * (static_cast<float>(offset + i) + 0.5f) / static_cast<float>(size) - 1.0f;
+        squares[i] = static_cast<double>(t) * static_cast<double>(t);
+    }
+    return squares;
+}
+
+// bit k is set if base + squares[k] <= 1, the loop has no branches so that it can be vectorized
+Row insideRow(double base, const std::vector<double>& squares) {
+    auto row = Row(0);
+    for (size_t k = 0; k < squares.size(); ++k) {
+        row |= Row(base + squares[k] <= 1.0) << k;
+    }
+    return row;
+}
+
+struct RowShape {
+    Rows air;
+    Rows block;
+};
+
+RowShape makeRowShape(const Dimensions& size) {
+    return RowShape{Rows(size.width, std::vector<Row>(size.height, 0)), Rows(size.width, std::vector<Row>(size.height, 0))};
+}
+
+// rect room
+
+RowShape rectShape(const Dimensions& size) {
+    auto [width, height, length] = size;
+    auto shape = makeRowShape(size);
+
+    for (size_t i = 0; i < width; ++i) {
+        for (size_t j = 0; j < height; ++j) {
+            auto inside = i > 0 && i < width - 1 && j > 0 && j < height - 1;
+            shape.air[i][j] = inside ? bitRange(1, length - 1) : 0;
+            shape.block[i][j] = bitRange(0, length) & ~shape.air[i][j];
         }
+    }
+
+    return shape;
+}
 
-    // set edge tiles
-    edgeTiles.clear();
+std::vector<glm::ivec3> rectEdgeTiles(const Dimensions& size) {
+    auto [width, height, length] = size;
+
+    auto edgeTiles = std::vector<glm::ivec3>();
     for (size_t i = 1; i < width - 1; ++i) {
         edgeTiles.push_back(glm::ivec3{i, 1, 0});
         edgeTiles.push_back(glm::ivec3{i, 1, length - 1});
@@ -150,179 +194,218 @@ void RectRoom::Generate(RNG& rng, SeedType seed) {
         edgeTiles.push_back(glm::ivec3{width - 1, 1, k});
     }
 
-    LOG_ASSERT(!edgeTiles.empty());
+    return edgeTiles;
 }
 
 // oval room
 
-template <typename T>
-using Vector2D = std::vector<std::vector<T>>;
+// Oval in the xz plane: air is the set of oval tiles whose 4 neighbours are in the oval,
+// walls are the remaining oval tiles that have an air neighbour.
+RowShape ovalShape(const Dimensions& size, std::vector<glm::ivec3>& edgeTiles) {
+    auto [width, height, length] = size;
 
-Vector2D<TileType> generateOval(size_t width, size_t height) {
-    auto insideOval = [&](size_t x, size_t y, size_t w, size_t h) {
-        return std::pow(2.0f * (x + 0.5f) / w - 1.0f, 2) + std::pow(2.0f * (y + 0.5f) / h - 1.0f, 2) <= 1.0f;
-    };
-
-    auto res = Vector2D<TileType>(width, std::vector<TileType>(height, TileType::Void));
+    auto xs = squaredCoordinates(width, width);
+    auto zs = squaredCoordinates(length, length);
 
+    auto oval = std::vector<Row>(width);
     for (size_t i = 0; i < width; ++i) {
-        for (size_t j = 0; j < height; ++j) {
-            if (insideOval(i, j, width, height)) {
-                res[i][j] = TileType::Block;
-            }
-        }
+        oval[i] = insideRow(xs[i], zs);
     }
 
-    auto copy = res;
+    auto inner = bitRange(1, length - 1);
+    auto air = std::vector<Row>(width, 0);
     for (size_t i = 1; i < width - 1; ++i) {
-        for (size_t j = 1; j < height - 1; ++j) {
-            if (copy[i][j] == TileType::Block && copy[i + 1][j] == TileType::Block && copy[i - 1][j] == TileType::Block &&
-                copy[i][j + 1] == TileType::Block && copy[i][j - 1] == TileType::Block) {
-                res[i][j] = TileType::Air;
-            }
+        air[i] = oval[i] & oval[i - 1] & oval[i + 1] & (oval[i] << 1) & (oval[i] >> 1) & inner;
+    }
+
+    auto walls = std::vector<Row>(width, 0);
+    for (size_t i = 0; i < width; ++i) {
+        walls[i] = oval[i] & ~air[i];
+        if (i > 0 && i < width - 1) {
+            walls[i] &= (air[i - 1] | air[i + 1] | (air[i] << 1) | (air[i] >> 1)) | ~inner;
         }
     }
 
-    for (size_t i = 1; i < width - 1; ++i) {
+    auto shape = makeRowShape(size);
+    for (size_t i = 0; i < width; ++i) {
+        forEachBit(walls[i], [&](size_t k) { edgeTiles.push_back(glm::ivec3{i, 1, k}); });
+
+        shape.block[i][0] = shape.block[i][height - 1] = walls[i] | air[i];
         for (size_t j = 1; j < height - 1; ++j) {
-            if (res[i][j] == TileType::Block && res[i + 1][j] != TileType::Air && res[i - 1][j] != TileType::Air && res[i][j + 1] != TileType::Air &&
-                res[i][j - 1] != TileType::Air) {
-                res[i][j] = TileType::Void;
-            }
+            shape.air[i][j] = air[i];
+            shape.block[i][j] = walls[i];
         }
     }
 
-    return res;
+    return shape;
 }
 
-void OvalRoom::Generate(RNG& rng, SeedType seed) {
-    auto width = rng.IntUniform<size_t>(9, 18);
-    auto height = rng.IntUniform<size_t>(6, 8);
-    auto length = rng.IntUniform<size_t>(9, 18);
-    size = Dimensions{width, height, length};
-    tiles = TilesVec(size, Tile{TileType::Void, TileOrientation::None, TextureType::None, glm::vec3(1.0f)});
+// ellipsoid room
 
-    auto air = Tile{TileType::Air, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
-    auto wall = Tile{TileType::Block, TileOrientation::None, TextureType::Texture1,
-                     glm::vec3(rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f))};
+// Ellipsoid cut at the quarter of its height: air is the set of ellipsoid tiles whose 6 neighbours are in the ellipsoid,
+// walls are the remaining ellipsoid tiles that have an air neighbour.
+RowShape ellipsoidShape(const Dimensions& size, std::vector<glm::ivec3>& edgeTiles) {
+    auto [width, height, length] = size;
 
-    auto oval = generateOval(width, length);
+    auto xs = squaredCoordinates(width, width);
+    auto ys = squaredCoordinates(height, height + height / 4, height / 4);
+    auto zs = squaredCoordinates(length, length);
 
+    auto ellipsoid = Rows(width, std::vector<Row>(height));
     for (size_t i = 0; i < width; ++i) {
-        for (size_t k = 0; k < length; ++k) {
-            if (oval[i][k] == TileType::Void) {
-                continue;
-            }
+        for (size_t j = 0; j < height; ++j) {
+            ellipsoid[i][j] = insideRow(xs[i] + ys[j], zs);
+        }
+    }
+
+    auto inner = bitRange(1, length - 1);
+    auto shape = makeRowShape(size);
+    auto& air = shape.air;
+    auto& walls = shape.block;
+
+    for (size_t i = 1; i < width - 1; ++i) {
+        for (size_t j = 1; j < height - 1; ++j) {
+            auto row = ellipsoid[i][j];
+            air[i][j] = row & ellipsoid[i - 1][j] & ellipsoid[i + 1][j] & ellipsoid[i][j - 1] & ellipsoid[i][j + 1] & (row << 1) & (row >> 1) & inner;
+        }
+    }
 
-            tiles.Set(i, 0, k, wall);
-            tiles.Set(i, height - 1, k, wall);
-
-            if (oval[i][k] == TileType::Block) {
-                edgeTiles.push_back(glm::ivec3{i, 1, k});
-
-                for (size_t j = 1; j < height - 1; ++j) {
-                    tiles.Set(i, j, k, wall);
-                }
-            } else if (oval[i][k] == TileType::Air) {
-                for (size_t j = 1; j < height - 1; ++j) {
-                    tiles.Set(i, j, k, air);
-                }
-            } else {
-                LOG_ASSERT(false);
+    for (size_t i = 0; i < width; ++i) {
+        for (size_t j = 0; j < height; ++j) {
+            walls[i][j] = ellipsoid[i][j] & ~air[i][j];
+            if (i > 0 && i < width - 1 && j > 0 && j < height - 1) {
+                auto row = air[i][j];
+                walls[i][j] &= (air[i - 1][j] | air[i + 1][j] | air[i][j - 1] | air[i][j + 1] | (row << 1) | (row >> 1)) | ~inner;
             }
         }
     }
+
+    // walls with void below and a wall above
+    for (size_t i = 0; i < width; ++i) {
+        for (size_t j = 1; j < height - 1; ++j) {
+            auto edges = walls[i][j] & ~(walls[i][j - 1] | air[i][j - 1]) & walls[i][j + 1];
+            forEachBit(edges, [&](size_t k) { edgeTiles.push_back(glm::ivec3{i, j, k}); });
+        }
+    }
+
+    return shape;
 }
 
-// ellipsoid room
+std::vector<Row> intersectionRows(const RowShape& shape, const Dimensions& size) {
+    auto [width, height, length] = size;
+    LOG_ASSERT(length <= MaxRoomLength());
 
-void EllipsoidRoom::Generate(RNG& rng, SeedType seed) {
-    auto width = rng.IntUniform<size_t>(12, 18);
-    auto height = rng.IntUniform<size_t>(7, 10);
-    auto length = rng.IntUniform<size_t>(12, 18);
-    size = Dimensions{width, height, length};
+    auto rows = std::vector<Row>((width + 2) * (height + 2), 0);
+    auto row = [&](size_t x, size_t y) -> Row& { return rows[x * (height + 2) + y]; };
 
-    auto voidTile = Tile{TileType::Void, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
-    tiles = TilesVec(size, voidTile);
+    for (size_t i = 0; i < width; ++i) {
+        for (size_t j = 0; j < height; ++j) {
+            auto tiles = (shape.air[i][j] | shape.block[i][j]) << 1;
 
-    auto air = Tile{TileType::Air, TileOrientation::None, TextureType::None, glm::vec3(1.0f)};
-    auto wall = Tile{TileType::Block, TileOrientation::None, TextureType::Texture1,
-                     glm::vec3(rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f))};
-
-    auto insideEllipsoid = [&](int x, int y, int z, size_t w, size_t h, size_t l) {
-        return std::pow(2.0f * (x + 0.5f) / w - 1.0f, 2) + std::pow(2.0f * (y + 0.5f) / h - 1.0f, 2) + std::pow(2.0f * (z + 0.5f) / l - 1.0f, 2) <=
-               1.0f;
-    };
-
-    for (int i = 0; i < width; ++i) {
-        for (int j = 0; j < height; ++j) {
-            for (int k = 0; k < length; ++k) {
-                if (insideEllipsoid(i, j + height / 4, k, width, height + height / 4, length)) {
-                    tiles.Set(i, j, k, wall);
-                }
-            }
+            row(i + 1, j + 1) |= tiles | (tiles << 1) | (tiles >> 1);
+            row(i, j + 1) |= tiles;
+            row(i + 2, j + 1) |= tiles;
+            row(i + 1, j) |= tiles;
+            row(i + 1, j + 2) |= tiles;
         }
     }
 
-    auto copy = tiles;
-    for (int i = 1; i < width - 1; ++i) {
-        for (int j = 1; j < height - 1; ++j) {
-            for (int k = 1; k < length - 1; ++k) {
-                auto coords = glm::ivec3(i, j, k);
-
-                if (copy.Get(coords).type != wall.type) {
-                    continue;
-                }
-
-                auto setToAir = true;
-                for (const auto& neighbour : GetNeighbours(coords)) {
-                    if (copy.Get(neighbour).type != wall.type) {
-                        setToAir = false;
-                        break;
-                    }
-                }
-
-                if (setToAir) {
-                    tiles.Set(coords, air);
-                }
-            }
-        }
+    return rows;
+}
+
+std::vector<Row> flatten(const Rows& rows) {
+    auto res = std::vector<Row>();
+    for (const auto& column : rows) {
+        res.insert(res.end(), column.begin(), column.end());
     }
+    return res;
+}
 
-    for (int i = 1; i < width - 1; ++i) {
-        for (int j = 1; j < height - 1; ++j) {
-            for (int k = 1; k < length - 1; ++k) {
-                auto coords = glm::ivec3(i, j, k);
-
-                if (tiles.Get(coords).type != wall.type) {
-                    continue;
-                }
-
-                auto setToVoid = true;
-                for (const auto& neighbour : GetNeighbours(coords)) {
-                    if (tiles.Get(neighbour).type == air.type) {
-                        setToVoid = false;
-                        break;
-                    }
-                }
-
-                if (setToVoid) {
-                    tiles.Set(coords, voidTile);
-                }
-            }
-        }
+RoomShape makeShape(RoomType type, const Dimensions& size) {
+    LOG_ASSERT(size.length <= 64);
+
+    auto shape = RoomShape();
+    auto rows = RowShape();
+    switch (type) {
+        case RoomType::Rect:
+            rows = rectShape(size);
+            shape.edgeTiles = rectEdgeTiles(size);
+            break;
+        case RoomType::Oval:
+            rows = ovalShape(size, shape.edgeTiles);
+            break;
+        case RoomType::Ellipsoid:
+            rows = ellipsoidShape(size, shape.edgeTiles);
+            break;
+        default:
+            LOG_ASSERT(false);
     }
 
-    for (int i = 0; i < width; ++i) {
-        for (int j = 1; j < height - 1; ++j) {
-            for (int k = 0; k < length; ++k) {
-                auto coords = glm::ivec3(i, j, k);
+    LOG_ASSERT(type != RoomType::Rect || !shape.edgeTiles.empty());
+    shape.airRows = flatten(rows.air);
+    shape.wallRows = flatten(rows.block);
+    shape.intersectionRows = intersectionRows(rows, size);
 
-                if (tiles.Get(coords).type == wall.type && tiles.Get(coords + glm::ivec3{0, -1, 0}).type == voidTile.type &&
-                    tiles.Get(coords + glm::ivec3{0, 1, 0}).type == wall.type) {
-                    edgeTiles.push_back(coords);
-                }
-            }
+    return shape;
+}
+
+}  // namespace
+
+RoomShapeHandle GetRoomShape(RoomType type, const Dimensions& size) {
+    static auto mutex = std::mutex();
+    static auto shapes = std::map<std::tuple<RoomType, size_t, size_t, size_t>, RoomShapeHandle>();
+
+    auto key = std::make_tuple(type, size.width, size.height, size.length);
+
+    auto lock = std::lock_guard(mutex);
+    auto& shape = shapes[key];
+    if (!shape) {
+        shape = std::make_shared<const RoomShape>(makeShape(type, size));
+    }
+    return shape;
+}
+
+// room generation code
+
+namespace {
+
+Dimensions randomRoomSize(RoomType type, RNG& rng) {
+    switch (type) {
+        case RoomType::Rect:
+        case RoomType::Oval: {
+            auto width = rng.IntUniform<size_t>(9, 18);
+            auto height = rng.IntUniform<size_t>(6, 8);
+            auto length = rng.IntUniform<size_t>(9, 18);
+            return Dimensions{width, height, length};
+        }
+        case RoomType::Ellipsoid: {
+            auto width = rng.IntUniform<size_t>(12, 18);
+            auto height = rng.IntUniform<size_t>(7, 10);
+            auto length = rng.IntUniform<size_t>(12, 18);
+            return Dimensions{width, height, length};
         }
+        default:
+            LOG_ASSERT(false);
+            return Dimensions();
     }
 }
+
+}  // namespace
+
+Room GenerateRoom(RoomType type, RNG& rng) {
+    auto room = Room();
+    room.type = type;
+    room.size = randomRoomSize(type, rng);
+    room.wallColor = glm::vec3(rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f), rng.RealUniform(0.3f, 1.0f));
+    room.shape = GetRoomShape(type, room.size);
+    return room;
+}
+
+Room MakeRoom(RoomType type, const glm::ivec3& offset, const Dimensions& size) {
+    auto room = Room();
+    room.type = type;
+    room.offset = offset;
+    room.size = size;
+    room.shape = GetRoomShape(type, size);
+    return room;
+}
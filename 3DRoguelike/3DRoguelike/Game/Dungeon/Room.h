@@ -1,7 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
-#include <unordered_set>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -21,51 +22,54 @@ bool BoxesIntersect(const Box& box1, const Box& box2);
 
 bool PointInsideBox(const glm::ivec3& coords, const Box& box);
 
-// IRoom interface
+enum struct RoomType { Rect, Oval, Ellipsoid };
 
-class IRoom {
- public:
-    IRoom() = default;
-    virtual ~IRoom() = default;
+// room shapes
 
-    virtual void Generate(RNG& rng, SeedType seed) = 0;
+// Geometry of the room, it depends only on the room type and size (rooms differ only by the wall colour),
+// so it is computed once and shared by all rooms of the same type and size.
+struct RoomShape {
+    // z-rows of the room, bit z of airRows[x * height + y] (wallRows[x * height + y]) is set if tile (x, y, z) is air (wall),
+    // other tiles are void
+    std::vector<std::uint64_t> airRows;
+    std::vector<std::uint64_t> wallRows;
+    // wall tiles that corridors can start from (in room coordinates)
+    std::vector<glm::ivec3> edgeTiles;
+    // non-void tiles and their neighbours, bit z + 1 of intersectionRows[(x + 1) * (height + 2) + y + 1] is set for tile (x, y, z)
+    std::vector<std::uint64_t> intersectionRows;
+};
 
-    const std::vector<glm::ivec3>& GetEdgeTiles() const;
-    void Place(TilesVec& dungeon) const;
-    const std::unordered_set<glm::ivec3>& GetIntersectionTiles();
+using RoomShapeHandle = std::shared_ptr<const RoomShape>;
 
- public:
-    glm::ivec3 offset;
-    Dimensions size;
-    TilesVec tiles;
+// returns cached shape of the room (thread-safe), shape is computed on the first request
+RoomShapeHandle GetRoomShape(RoomType type, const Dimensions& size);
 
- protected:
-    std::vector<glm::ivec3> edgeTiles;
-    std::unordered_set<glm::ivec3> intersectionTiles;
+// room
+
+// Rooms are stored by value, geometry of the room is shared with all rooms of the same type and size.
+struct Room {
+    RoomType type = RoomType::Rect;
+    glm::ivec3 offset = glm::ivec3();
+    Dimensions size = Dimensions();
+    glm::vec3 wallColor = glm::vec3(1.0f);
+    RoomShapeHandle shape;
+
+    const std::vector<glm::ivec3>& GetEdgeTiles() const;
+    void Place(TilesVec& dungeon) const;
 };
 
 // Room helper functions
 
-using Room = std::shared_ptr<IRoom>;
+// generates size and wall colour of the room of the given type (offset is not set)
+Room GenerateRoom(RoomType type, RNG& rng);
+// room with the given type, offset and size (wall colour is not known, e.g. for rooms of loaded levels)
+Room MakeRoom(RoomType type, const glm::ivec3& offset, const Dimensions& size);
+// size of the smallest room that can be generated
+Dimensions MinRoomSize();
+// length of the longest room that has a shape (z-rows of a room and the tiles around it are 64-bit masks)
+size_t MaxRoomLength();
 
 bool RoomsIntersect(const Room& r1, const Room& r2);
 
 glm::vec3 RoomCenter(const Room& room);
 glm::ivec3 RoomCenterCoords(const Room& room);
-
-// different rooms
-
-class RectRoom : public IRoom {
- public:
-    void Generate(RNG& rng, SeedType seed) override;
-};
-
-class OvalRoom : public IRoom {
- public:
-    void Generate(RNG& rng, SeedType seed) override;
-};
-
-class EllipsoidRoom : public IRoom {
- public:
-    void Generate(RNG& rng, SeedType seed) override;
-};
@@ -0,0 +1,473 @@
+#include "TileRenderData.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <thread>
+#include <utility>
+
+#include "Portals.h"
+#include "../Assert.h"
+
+namespace {
+
+std::array<std::uint8_t, 4> packColor(const glm::vec3& color) {
+    auto rgb = glm::round(glm::clamp(color, 0.0f, 1.0f) * 255.0f);
+    return {static_cast<std::uint8_t>(rgb.r), static_cast<std::uint8_t>(rgb.g), static_cast<std::uint8_t>(rgb.b), 255};
+}
+
+void addStairs(const glm::ivec3& coords, const Tile& tile, RegionId region, ChunkRenderData& data) {
+    if (tile.type != TileType::StairsTopPart) {
+        return;
+    }
+
+    if (tile.orientation == TileOrientation::North) {
+        data.stairs.push_back(MakeTileInstance(coords, tile.color, 0));
+    } else if (tile.orientation == TileOrientation::West) {
+        data.stairs.push_back(MakeTileInstance(coords, tile.color, 1));
+    } else if (tile.orientation == TileOrientation::South) {
+        data.stairs.push_back(MakeTileInstance(coords, tile.color, 2));
+    } else if (tile.orientation == TileOrientation::East) {
+        data.stairs.push_back(MakeTileInstance(coords, tile.color, 3));
+    } else {
+        return;
+    }
+
+    auto it = std::lower_bound(data.stairsRegions.begin(), data.stairsRegions.end(), region);
+    if (it == data.stairsRegions.end() || *it != region) {
+        data.stairsRegions.insert(it, region);
+    }
+}
+
+// Colors of solid blocks in the box [lo, hi) and one tile around it, 0 for other tiles, otherwise index of the color in the palette + 1.
+// Cells of the portal graph (see CellOfTile) of the other tiles are stored as well.
+class BlockGrid {
+ public:
+    // calls func(coords, tile, cell) for every tile in the box, that is not a solid block
+    template <typename Func>
+    BlockGrid(const TilesVec& tiles, const RegionsVec& regions, const glm::ivec3& lo_, const glm::ivec3& hi_, Func&& func)
+        : lo(lo_ - 1), size(hi_ - lo_ + 2), strides(static_cast<size_t>(size.y) * size.z, size.z, 1) {
+        cells.resize(static_cast<size_t>(size.x) * size.y * size.z);
+        tileCells.resize(cells.size());
+        auto regionsSize = AsIVec3(regions.GetDimensions());
+
+        // most of the blocks have the same color as the previous one
+        auto previousColor = glm::vec3(-1.0f);
+        auto previousIndex = std::uint32_t(0);
+
+        auto cell = cells.begin();
+        auto tileCell = tileCells.begin();
+        for (auto x = lo.x; x < lo.x + size.x; ++x) {
+            for (auto y = lo.y; y < lo.y + size.y; ++y) {
+                // rows of the region map (linear layout) are contiguous, so the loop below reads them without function calls
+                auto rowInBounds = x >= 0 && x < regionsSize.x && y >= 0 && y < regionsSize.y;
+                const auto* regionRow = rowInBounds ? &regions.Get(glm::ivec3(x, y, 0)) : nullptr;
+
+                for (auto z = lo.z; z < lo.z + size.z; ++z, ++cell, ++tileCell) {
+                    auto coords = glm::ivec3(x, y, z);
+                    if (!tiles.IsInBoundsOrBorder(coords)) {
+                        continue;
+                    }
+
+                    const auto& tile = tiles.Get(coords);
+                    if (!IsSolidBlock(tile.type)) {
+                        // same as CellOfTile
+                        auto inBounds = regionRow != nullptr && z >= 0 && z < regionsSize.z;
+                        *tileCell = tile.type != TileType::Void && inBounds ? regionRow[z] : RegionId(0);
+
+                        // coords are in the box and not in the tiles around it
+                        auto local = glm::uvec3(coords - lo - 1);
+                        if (local.x < static_cast<unsigned>(size.x - 2) && local.y < static_cast<unsigned>(size.y - 2) &&
+                            local.z < static_cast<unsigned>(size.z - 2)) {
+                            func(coords, tile, *tileCell);
+                        }
+                        continue;
+                    }
+
+                    if (tile.color != previousColor) {
+                        previousColor = tile.color;
+                        previousIndex = colorIndex(tile.color);
+                    }
+                    *cell = previousIndex;
+                }
+            }
+        }
+    }
+
+    // Coarse cells of scale^3 tiles in the box [lo, hi) and one cell around it,
+    // cell c covers the tiles [origin + c * scale, origin + (c + 1) * scale), which are read from the blocks (grid of the tiles).
+    // Cell is solid if it has at least as many solid blocks as a wall across it (scale^2, most of the walls are one tile thick),
+    // it takes the most common color of its blocks. Cells of the portal graph are not stored (all faces face region 0).
+    BlockGrid(const BlockGrid& blocks, const glm::ivec3& origin, int scale, const glm::ivec3& lo_, const glm::ivec3& hi_)
+        : lo(lo_ - 1), size(hi_ - lo_ + 2), strides(static_cast<size_t>(size.y) * size.z, size.z, 1) {
+        cells.resize(static_cast<size_t>(size.x) * size.y * size.z);
+        tileCells.resize(cells.size());
+
+        // colors of the blocks of a cell (cells of the blocks) and their counts
+        auto colors = std::vector<std::pair<std::uint32_t, int>>();
+        auto cell = cells.begin();
+        for (auto x = lo.x; x < lo.x + size.x; ++x) {
+            for (auto y = lo.y; y < lo.y + size.y; ++y) {
+                for (auto z = lo.z; z < lo.z + size.z; ++z, ++cell) {
+                    colors.clear();
+                    auto solid = 0;
+                    auto first = blocks.Index(origin + glm::ivec3(x, y, z) * scale);
+                    for (auto tx = 0; tx < scale; ++tx) {
+                        for (auto ty = 0; ty < scale; ++ty) {
+                            auto index = first + tx * blocks.Stride(0) + ty * blocks.Stride(1);
+                            for (auto tz = 0; tz < scale; ++tz, ++index) {
+                                auto block = blocks.Get(index);
+                                if (block == 0) {
+                                    continue;
+                                }
+
+                                ++solid;
+                                auto it = std::find_if(colors.begin(), colors.end(), [&](const auto& entry) { return entry.first == block; });
+                                if (it == colors.end()) {
+                                    colors.emplace_back(block, 1);
+                                } else {
+                                    ++it->second;
+                                }
+                            }
+                        }
+                    }
+
+                    if (solid >= scale * scale) {
+                        // first of the most common colors, so that the result does not depend on anything but the tiles
+                        auto byCount = [](const auto& a, const auto& b) { return a.second < b.second; };
+                        *cell = colorIndex(blocks.GetColor(std::max_element(colors.begin(), colors.end(), byCount)->first));
+                    }
+                }
+            }
+        }
+    }
+
+    size_t Index(const glm::ivec3& coords) const {
+        auto local = coords - lo;
+        return local.x * strides.x + local.y * strides.y + local.z;
+    }
+
+    // difference of indices of adjacent cells along the axis
+    size_t Stride(int axis) const {
+        return strides[axis];
+    }
+
+    std::uint32_t Get(size_t index) const {
+        return cells[index];
+    }
+
+    // cell of the portal graph of the tile, that is not a solid block
+    RegionId GetTileCell(size_t index) const {
+        return tileCells[index];
+    }
+
+    const glm::vec3& GetColor(std::uint32_t cell) const {
+        return palette[cell - 1];
+    }
+
+ private:
+    // cell value of the color, the color is added to the palette if it is new
+    std::uint32_t colorIndex(const glm::vec3& color) {
+        auto key = std::array{color.r, color.g, color.b};
+        auto [it, inserted] = colorIndices.try_emplace(key, static_cast<std::uint32_t>(palette.size() + 1));
+        if (inserted) {
+            palette.push_back(color);
+        }
+        return it->second;
+    }
+
+ private:
+    glm::ivec3 lo;
+    glm::ivec3 size;
+    glm::size3 strides;
+    std::vector<std::uint32_t> cells;
+    std::vector<RegionId> tileCells;
+    std::vector<glm::vec3> palette;
+    std::map<std::array<float, 3>, std::uint32_t> colorIndices;
+};
+
+// Greedy meshing: faces of solid blocks in the box [lo, hi) that do not touch other solid blocks are collected slice by slice,
+// then rectangles of faces with the same color, normal and region in front of them are merged into one quad.
+// Faces between two solid blocks are never visible, so quads may cover them too.
+// Coordinates of a coarse grid are converted to tiles with the origin and the scale of the grid.
+void addBlockFaces(const BlockGrid& grid, const glm::ivec3& lo, const glm::ivec3& hi, std::map<RegionId, std::vector<MeshVertex>>& vertices,
+                   const glm::ivec3& origin = glm::ivec3(), int scale = 1) {
+    static constexpr auto hidden = std::numeric_limits<std::uint32_t>::max();
+    // faces are keyed by color (lower half) and region (upper half), colors fit because the box is small (see BuildChunkRenderData)
+    static constexpr auto regionShift = 16;
+    auto mask = std::vector<std::uint32_t>();
+    auto lastRegion = RegionId(0);
+    std::vector<MeshVertex>* regionVertices = nullptr;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        // rows of the mask go along the axis with the smallest stride (z, or y for z faces)
+        auto u = axis == 2 ? 1 : 2;
+        auto v = axis == 0 ? 1 : 0;
+        // (u, v) quads are counter-clockwise when seen from +axis if (axis, u, v) is a right-handed basis
+        auto rightHanded = u == (axis + 1) % 3;
+        auto width = hi[u] - lo[u];
+        auto height = hi[v] - lo[v];
+        mask.resize(static_cast<size_t>(width) * height);
+
+        auto strideU = grid.Stride(u);
+        auto strideV = grid.Stride(v);
+
+        for (int side = -1; side <= 1; side += 2) {
+            auto strideNormal = grid.Stride(axis);
+
+            for (auto slice = lo[axis]; slice < hi[axis]; ++slice) {
+                auto first = glm::ivec3();
+                first[axis] = slice;
+                first[u] = lo[u];
+                first[v] = lo[v];
+                auto rowIndex = grid.Index(first);
+                for (int j = 0; j < height; ++j, rowIndex += strideV) {
+                    auto index = rowIndex;
+                    for (int i = 0; i < width; ++i, index += strideU) {
+                        auto cell = grid.Get(index);
+                        auto neighbourIndex = side > 0 ? index + strideNormal : index - strideNormal;
+                        auto neighbour = grid.Get(neighbourIndex);
+                        mask[j * width + i] = cell == 0           ? 0
+                                              : neighbour == 0 ? cell | std::uint32_t(grid.GetTileCell(neighbourIndex)) << regionShift
+                                                               : hidden;
+                    }
+                }
+
+                for (int j = 0; j < height; ++j) {
+                    for (int i = 0; i < width;) {
+                        auto cell = mask[j * width + i];
+                        if (cell == 0 || cell == hidden) {
+                            ++i;
+                            continue;
+                        }
+
+                        auto covers = [&](std::uint32_t other) { return other == cell || other == hidden; };
+                        auto visible = [&](std::uint32_t other) { return other == cell; };
+
+                        // quad does not end with hidden faces
+                        auto quadWidth = 1;
+                        for (auto end = 1; i + end < width && covers(mask[j * width + i + end]); ++end) {
+                            if (visible(mask[j * width + i + end])) {
+                                quadWidth = end + 1;
+                            }
+                        }
+
+                        auto quadHeight = 1;
+                        for (auto end = 1; j + end < height; ++end) {
+                            auto row = mask.begin() + (j + end) * width + i;
+                            if (!std::all_of(row, row + quadWidth, covers)) {
+                                break;
+                            }
+                            if (std::any_of(row, row + quadWidth, visible)) {
+                                quadHeight = end + 1;
+                            }
+                        }
+
+                        // covered hidden faces can be covered by other quads as well
+                        for (int k = 0; k < quadHeight; ++k) {
+                            auto row = mask.begin() + (j + k) * width + i;
+                            std::replace(row, row + quadWidth, cell, std::uint32_t(0));
+                        }
+
+                        auto color = packColor(grid.GetColor(cell & ((1u << regionShift) - 1)));
+                        auto corner = [&](int di, int dj) {
+                            // twice the position of the corner
+                            auto position = glm::ivec3();
+                            position[axis] = 2 * slice + side;
+                            position[u] = 2 * (lo[u] + i + di) - 1;
+                            position[v] = 2 * (lo[v] + j + dj) - 1;
+                            // sides of the cells are at the sides of their first and last tiles
+                            position = 2 * origin - 1 + (position + 1) * scale;
+                            auto packed = std::array{static_cast<std::int16_t>(position.x), static_cast<std::int16_t>(position.y),
+                                                     static_cast<std::int16_t>(position.z)};
+                            return MeshVertex{packed, static_cast<std::int16_t>(axis), color};
+                        };
+                        auto quad = std::array{corner(0, 0), corner(quadWidth, 0), corner(quadWidth, quadHeight), corner(0, quadHeight)};
+                        if ((side < 0) == rightHanded) {
+                            std::swap(quad[1], quad[3]);
+                        }
+                        // adjacent quads usually face the same region
+                        auto region = static_cast<RegionId>(cell >> regionShift);
+                        if (regionVertices == nullptr || region != lastRegion) {
+                            regionVertices = &vertices[region];
+                            lastRegion = region;
+                        }
+                        regionVertices->insert(regionVertices->end(), {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]});
+
+                        i += quadWidth;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// chunks that cover the tiles (including the border) [origin, end)
+struct ChunkLayout {
+    glm::ivec3 origin;
+    glm::ivec3 end;
+    glm::ivec3 counts;
+
+    explicit ChunkLayout(const TilesVec& tiles) {
+        // border is rendered together with the grid
+        auto border = static_cast<int>(tiles.GetBorder());
+        origin = glm::ivec3(-border);
+        end = AsIVec3(tiles.GetDimensions()) + border;
+        counts = (end - origin + chunkSize - 1) / chunkSize;
+    }
+
+    size_t Index(const glm::ivec3& chunk) const {
+        return (static_cast<size_t>(chunk.x) * counts.y + chunk.y) * counts.z + chunk.z;
+    }
+
+    glm::ivec3 Chunk(size_t index) const {
+        auto z = index % counts.z;
+        auto y = index / counts.z % counts.y;
+        auto x = index / counts.z / counts.y;
+        return glm::ivec3(x, y, z);
+    }
+};
+
+}  // namespace
+
+TileInstance MakeTileInstance(const glm::ivec3& coords, const glm::vec3& color, int orientation) {
+    static constexpr auto min = std::numeric_limits<std::int16_t>::min();
+    static constexpr auto max = std::numeric_limits<std::int16_t>::max();
+    LOG_ASSERT(glm::all(glm::greaterThanEqual(coords, glm::ivec3(min))) && glm::all(glm::lessThanEqual(coords, glm::ivec3(max))));
+    LOG_ASSERT(orientation >= 0 && orientation < 4);
+
+    return TileInstance{{static_cast<std::int16_t>(coords.x), static_cast<std::int16_t>(coords.y), static_cast<std::int16_t>(coords.z)},
+                        static_cast<std::int16_t>(orientation),
+                        packColor(color)};
+}
+
+TileRenderData BuildTileRenderData(const TilesVec& tiles, const RegionsVec& regions, size_t threads) {
+    auto layout = ChunkLayout(tiles);
+
+    auto data = TileRenderData();
+    data.origin = layout.origin;
+    data.chunkCounts = layout.counts;
+
+    // every chunk is built into its own slot, so that threads do not share anything but the input
+    auto count = Volume(FromIVec3(layout.counts));
+    data.chunks.resize(count);
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, count);
+
+    // chunks are distributed dynamically, because chunks with rooms take longer than empty ones
+    auto next = std::atomic<size_t>(0);
+    auto worker = [&]() {
+        for (auto i = next++; i < count; i = next++) {
+            auto lo = layout.origin + layout.Chunk(i) * chunkSize;
+            data.chunks[i] = BuildChunkRenderData(tiles, regions, lo, glm::min(lo + chunkSize, layout.end));
+        }
+    };
+
+    // calling thread is one of the workers
+    auto workers = std::vector<std::thread>();
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    return data;
+}
+
+ChunkRenderData BuildChunkRenderData(const TilesVec& tiles, const RegionsVec& regions, size_t index) {
+    auto layout = ChunkLayout(tiles);
+    LOG_ASSERT(index < Volume(FromIVec3(layout.counts)));
+
+    auto lo = layout.origin + layout.Chunk(index) * chunkSize;
+    return BuildChunkRenderData(tiles, regions, lo, glm::min(lo + chunkSize, layout.end));
+}
+
+void AddChunksOfTile(const TilesVec& tiles, const glm::ivec3& coords, std::vector<size_t>& chunks) {
+    auto layout = ChunkLayout(tiles);
+
+    // faces of a block depend only on the tiles that share them, faces of a coarse cell depend on the cells that share them,
+    // chunks are aligned to the cells of all levels, so the chunks of the cells next to the coarsest cell of the tile cover all levels
+    auto scale = lodScales.back();
+    auto cell = (coords - layout.origin) / scale;
+    auto affected = std::array<glm::ivec3, 7>();
+    affected[0] = coords;
+    auto neighbours = GetNeighbours(cell);
+    std::transform(neighbours.begin(), neighbours.end(), affected.begin() + 1,
+                   [&](const auto& neighbour) { return layout.origin + neighbour * scale; });
+
+    for (const auto& tile : affected) {
+        if (!IsInBounds(tile - layout.origin, FromIVec3(layout.end - layout.origin))) {
+            continue;
+        }
+
+        auto index = layout.Index((tile - layout.origin) / chunkSize);
+        auto it = std::lower_bound(chunks.begin(), chunks.end(), index);
+        if (it == chunks.end() || *it != index) {
+            chunks.insert(it, index);
+        }
+    }
+}
+
+ChunkRenderData BuildChunkRenderData(const TilesVec& tiles, const RegionsVec& regions, const glm::ivec3& lo, const glm::ivec3& hi) {
+    // tiles are read once for all levels of detail: the grid contains the tiles of the coarsest cells around the box,
+    // coarse cells of all levels start at the box
+    auto origin = ChunkLayout(tiles).origin;
+    auto padding = lodScales.back();
+    for (auto scale : lodScales) {
+        LOG_ASSERT((lo - origin) / scale * scale == lo - origin && scale <= padding);
+    }
+    auto gridLo = lo - padding;
+    auto gridHi = lo + (hi - lo + padding - 1) / padding * padding + padding;
+    // twice the coordinates of the corners of the tiles in the grid fit into the vertices
+    static constexpr auto min = std::numeric_limits<std::int16_t>::min();
+    static constexpr auto max = std::numeric_limits<std::int16_t>::max();
+    LOG_ASSERT(glm::all(glm::greaterThanEqual(2 * gridLo - 1, glm::ivec3(min))) && glm::all(glm::lessThanEqual(2 * gridHi + 1, glm::ivec3(max))));
+
+    // boxes of the tiles around the chunk have fewer colors than the key of a face can hold
+    auto gridSize = gridHi - gridLo;
+    LOG_ASSERT(static_cast<size_t>(gridSize.x) * gridSize.y * gridSize.z < 65536);
+
+    auto data = ChunkRenderData{lo, hi, {}, {}, {}, {}, {}};
+
+    auto grid = BlockGrid(tiles, regions, gridLo + 1, gridHi - 1, [&](const glm::ivec3& coords, const Tile& tile, RegionId cell) {
+        if (IsInBounds(coords - lo, FromIVec3(hi - lo))) {
+            addStairs(coords, tile, cell, data);
+        }
+    });
+
+    auto regionVertices = std::map<RegionId, std::vector<MeshVertex>>();
+    addBlockFaces(grid, lo, hi, regionVertices);
+
+    auto vertexCount = size_t(0);
+    for (const auto& [region, vertices] : regionVertices) {
+        vertexCount += vertices.size();
+    }
+    data.blocks.reserve(vertexCount);
+    for (const auto& [region, vertices] : regionVertices) {
+        data.blockRanges.push_back({region, static_cast<std::uint32_t>(data.blocks.size()), static_cast<std::uint32_t>(vertices.size())});
+        data.blocks.insert(data.blocks.end(), vertices.begin(), vertices.end());
+    }
+
+    for (size_t level = 0; level < lodScales.size(); ++level) {
+        auto scale = lodScales[level];
+        auto coarseLo = (lo - origin) / scale;
+        auto coarseHi = (hi - origin + scale - 1) / scale;
+        auto coarseGrid = BlockGrid(grid, origin, scale, coarseLo, coarseHi);
+
+        auto coarseVertices = std::map<RegionId, std::vector<MeshVertex>>();
+        addBlockFaces(coarseGrid, coarseLo, coarseHi, coarseVertices, origin, scale);
+        if (!coarseVertices.empty()) {
+            data.coarseBlocks[level] = std::move(coarseVertices.begin()->second);
+        }
+    }
+
+    return data;
+}
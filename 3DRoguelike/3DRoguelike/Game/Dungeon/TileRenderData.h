@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "WorldGrid.h"
+
+// per-instance data of a tile (12 bytes): grid coordinates and RGB8 color, converted to floats by the vertex attributes
+struct TileInstance {
+    std::array<std::int16_t, 3> position;
+    // quarter turns of the model around the y axis (same as RotateY)
+    std::int16_t orientation;
+    // alpha is not used
+    std::array<std::uint8_t, 4> color;
+};
+
+// coordinates must fit into 16 bits, orientation is in [0, 4)
+TileInstance MakeTileInstance(const glm::ivec3& coords, const glm::vec3& color, int orientation = 0);
+
+// vertex of the static mesh of blocks (12 bytes): corners of the tiles are at half-integer coordinates, so twice the position is stored,
+// texture coordinates are computed from the position and the axis of the face normal in the vertex shader (they repeat once per tile)
+struct MeshVertex {
+    std::array<std::int16_t, 3> position;
+    std::int16_t axis;
+    // alpha is not used
+    std::array<std::uint8_t, 4> color;
+};
+
+// vertices of the blocks [first, first + count) of a chunk, faces of the blocks in front of the region's tiles
+struct RegionRange {
+    RegionId region;
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+// size of the chunks (in tiles) that the world is split into for rendering
+static constexpr int chunkSize = 16;
+// coarse levels of detail: cells of scale^3 tiles (aligned to the chunks), chunkSize is divisible by the scales
+static constexpr std::array<int, 2> lodScales = {2, 4};
+
+// data of the tiles in the box [lo, hi), that should be rendered
+struct ChunkRenderData {
+    glm::ivec3 lo;
+    glm::ivec3 hi;
+    // triangles of the exposed faces of solid blocks, coplanar faces of the same color that face the same region are merged into rectangles
+    std::vector<MeshVertex> blocks;
+    // blocks are grouped by the region they face (sorted by region), so that regions hidden by portal culling are skipped
+    std::vector<RegionRange> blockRanges;
+    // blocks of the coarse levels of detail (lodScales), a cell is solid if it has at least scale^2 solid blocks (votes of its tiles
+    // with the threshold of a wall across the cell) and takes their most common color, faces are not split by regions
+    std::array<std::vector<MeshVertex>, lodScales.size()> coarseBlocks;
+    // per-instance data of stairs, all orientations are rendered with one model
+    std::vector<TileInstance> stairs;
+    // regions of the stairs tiles (sorted)
+    std::vector<RegionId> stairsRegions;
+};
+
+// data of all tiles (including the border), that should be rendered
+struct TileRenderData {
+    // chunk (x, y, z) starts at origin + (x, y, z) * chunkSize, chunks at the far sides of the world can be smaller
+    glm::ivec3 origin = glm::ivec3();
+    glm::ivec3 chunkCounts = glm::ivec3();
+    // x-major order
+    std::vector<ChunkRenderData> chunks;
+};
+
+// chunks are built in parallel on the given number of threads (0 - one per hardware thread)
+TileRenderData BuildTileRenderData(const TilesVec& tiles, const RegionsVec& regions, size_t threads = 0);
+// faces of the blocks on the boundary of the box take the tiles around the box into account,
+// the box must start at a chunk (so that coarse cells of neighbouring chunks match)
+ChunkRenderData BuildChunkRenderData(const TilesVec& tiles, const RegionsVec& regions, const glm::ivec3& lo, const glm::ivec3& hi);
+// render data of the chunk with the index in TileRenderData::chunks
+ChunkRenderData BuildChunkRenderData(const TilesVec& tiles, const RegionsVec& regions, size_t index);
+
+// adds indices (in TileRenderData::chunks) of the chunks, whose render data depends on the tile, to the sorted chunks:
+// the chunk of the tile, and the chunks next to it, if the tile is on their boundary or in a coarse cell on their boundary
+void AddChunksOfTile(const TilesVec& tiles, const glm::ivec3& coords, std::vector<size_t>& chunks);
@@ -1,35 +1,90 @@
 #include "TileRenderer.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "../Assert.h"
+#include "../Frustum.h"
 #include "../Utility/GLError.h"
 
-TileRenderer::TileRenderer()
-    : cubeModel(GetCubeModel()),
-      cubeInstancedModel(0, 0),
-      stairsModel{GetStairsModel(0), GetStairsModel(1), GetStairsModel(2), GetStairsModel(3)},
-      stairsInstancedModel{InstancedModel{0, 0}, InstancedModel{0, 0}, InstancedModel{0, 0}, InstancedModel{0, 0}},
-      shader(Assets::GetShader("cubeShader.vs", "cubeShader.fs")),
-      texture1(Assets::GetTexture("texture3.png")) {
+namespace {
+
+// distances (from the camera to the bounds of a chunk) from which the coarse levels of detail are used
+constexpr std::array<float, lodScales.size()> lodDistances = {40.0f, 70.0f};
+// level changes only when the distance is past the threshold by the margin, so that chunks near a threshold do not switch every frame
+constexpr float lodMargin = 4.0f;
+
+size_t selectLOD(size_t lod, float distance) {
+    while (lod < lodDistances.size() && distance > lodDistances[lod] + lodMargin) {
+        ++lod;
+    }
+    while (lod > 0 && distance < lodDistances[lod - 1] - lodMargin) {
+        --lod;
+    }
+    return lod;
 }
 
-void initInstancedRendering(const GLModel& model, InstancedModel& instancedModel, const std::vector<PositionColor>& tiles) {
-    if (tiles.empty()) {
-        return;
+// vertices of the blocks of all levels of detail
+size_t blocksVertexCount(const ChunkRenderData& data) {
+    auto count = data.blocks.size();
+    for (const auto& vertices : data.coarseBlocks) {
+        count += vertices.size();
     }
+    return count;
+}
+
+void setMeshAttributes(VAO vao, VBO vbo) {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // packed vertices are converted to floats: positions as integers (halved in the shader), colors normalized to [0, 1], axis stays an integer
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_SHORT, sizeof(MeshVertex), (void*)offsetof(MeshVertex, axis));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, color));
+
+    glBindVertexArray(0);
+}
+
+// empty vertex buffer of the blocks
+GLModel createMeshModel() {
+    VBO vbo;
+    VAO vao;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    setMeshAttributes(vao, vbo);
+
+    return {vao, vbo, 0};
+}
+
+void initInstancedRendering(const GLModel& model, InstancedModel& instancedModel) {
+    VAO vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
 
-    // configure instanced array
-    // -------------------------
+    glBindBuffer(GL_ARRAY_BUFFER, model.vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.ebo);
+
+    // configure instanced array, instances are uploaded every frame
+    // -----------------------------------------------------------------
     BufferId buffer;
     glGenBuffers(1, &buffer);
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, tiles.size() * sizeof(PositionColor), &tiles[0], GL_STATIC_DRAW);
 
-    glBindVertexArray(model.vao);
+    // packed instances are converted to floats: positions as integers, colors normalized to [0, 1], orientation stays an integer
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(PositionColor), (void*)0);
+    glVertexAttribPointer(2, 3, GL_SHORT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, position));
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(PositionColor), (void*)(sizeof(glm::vec3)));
+    glVertexAttribPointer(3, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TileInstance), (void*)offsetof(TileInstance, color));
     glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(PositionColor), (void*)(2 * sizeof(glm::vec3)));
+    glVertexAttribIPointer(4, 1, GL_SHORT, sizeof(TileInstance), (void*)offsetof(TileInstance, orientation));
 
     glVertexAttribDivisor(2, 1);
     glVertexAttribDivisor(3, 1);
@@ -37,51 +92,247 @@ void initInstancedRendering(const GLModel& model, InstancedModel& instancedModel
 
     glBindVertexArray(0);
 
-    if (instancedModel.cnt != 0) {
-        glDeleteBuffers(1, &instancedModel.buf);
-    }
-    instancedModel.cnt = tiles.size();
     instancedModel.buf = buffer;
+    instancedModel.vao = vao;
+}
+
+}  // namespace
+
+TileRenderer::TileRenderer()
+    : stairsModel(GetStairsModel(0)),
+      blocks(createMeshModel()),
+      blocksCapacity(0),
+      blocksEnd(0),
+      stairs(),
+      chunks(),
+      visibleChunks(),
+      blocksFirsts(),
+      blocksCounts(),
+      visibleStairs(),
+      portalGraph(),
+      visibleRegions(),
+      stats(),
+      shader(Assets::GetShader("cubeShader.vs", "cubeShader.fs")),
+      meshShader(Assets::GetShader("meshShader.vs", "cubeShader.fs")),
+      texture1(Assets::GetTexture("texture3.png")) {
+    initInstancedRendering(stairsModel, stairs);
 }
 
-void TileRenderer::InitInstancedRendering(const std::vector<PositionColor>& tiles, const std::array<std::vector<PositionColor>, 4>& stairs) {
-    initInstancedRendering(cubeModel, cubeInstancedModel, tiles);
-    for (size_t i = 0; i < 4; ++i) {
-        initInstancedRendering(stairsModel[i], stairsInstancedModel[i], stairs[i]);
+void TileRenderer::InitInstancedRendering(const TileRenderData& data) {
+    chunks = std::vector<Chunk>(data.chunks.size());
+    visibleChunks.clear();
+    visibleChunks.reserve(chunks.size());
+
+    // slots of the chunks are packed without gaps, they grow only when the chunks are edited
+    blocksEnd = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        auto& chunk = chunks[i];
+        const auto& chunkData = data.chunks[i];
+
+        // tiles are centered at integer coordinates, stairs extend to the next tile
+        chunk.min = glm::vec3(chunkData.lo) - 1.5f;
+        chunk.max = glm::vec3(chunkData.hi) + 0.5f;
+
+        chunk.blocksFirst = blocksEnd;
+        chunk.blocksCapacity = blocksVertexCount(chunkData);
+        chunk.stairs = chunkData.stairs;
+        chunk.stairsRegions = chunkData.stairsRegions;
+        blocksEnd += chunk.blocksCapacity;
+    }
+
+    blocksCapacity = blocksEnd;
+    glBindBuffer(GL_ARRAY_BUFFER, blocks.vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(blocksCapacity * sizeof(MeshVertex)), nullptr, GL_STATIC_DRAW);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        uploadBlocks(chunks[i], data.chunks[i]);
+    }
+}
+
+void TileRenderer::UpdateChunk(size_t index, const ChunkRenderData& data) {
+    LOG_ASSERT(index < chunks.size());
+    auto& chunk = chunks[index];
+
+    // chunk that does not fit into its slot gets a new one at the end of the buffer, with room for further edits,
+    // old slot is not reused until the next level
+    auto count = blocksVertexCount(data);
+    if (count > chunk.blocksCapacity) {
+        auto capacity = count + count / 2;
+        if (blocksEnd + capacity > blocksCapacity) {
+            growBlocks(std::max(blocksCapacity + blocksCapacity / 2, blocksEnd + capacity));
+        }
+
+        chunk.blocksFirst = blocksEnd;
+        chunk.blocksCapacity = capacity;
+        blocksEnd += capacity;
     }
+
+    glBindBuffer(GL_ARRAY_BUFFER, blocks.vbo);
+    uploadBlocks(chunk, data);
+    chunk.stairs = data.stairs;
+    chunk.stairsRegions = data.stairsRegions;
+}
+
+void TileRenderer::InitPortalCulling(std::vector<Portal> portals, size_t regionCount) {
+    portalGraph = PortalGraph(std::move(portals), regionCount);
+    visibleRegions.clear();
 }
 
-void TileRenderer::RenderTilesInstanced() {
-    InitRendering();
+void TileRenderer::RenderTilesInstanced(std::optional<RegionId> cameraRegion, bool cameraOutside) {
+    auto projectionView = Assets::Get().projection * Assets::Get().view;
+    auto frustum = Frustum(projectionView);
+
+    visibleRegions.clear();
+    if (cameraRegion.has_value() && cameraRegion.value() < portalGraph.GetRegionCount()) {
+        portalGraph.FindVisibleRegions(cameraRegion.value(), projectionView, visibleRegions);
+    }
+    stats.regionsVisible = static_cast<size_t>(std::count(visibleRegions.begin(), visibleRegions.end(), true));
+    stats.regionCount = portalGraph.GetRegionCount();
+
+    auto hasVisibleRegion = [&](const Chunk& chunk) {
+        return std::any_of(chunk.blockRanges.begin(), chunk.blockRanges.end(), [&](const auto& range) { return isRegionVisible(range.region); }) ||
+               std::any_of(chunk.stairsRegions.begin(), chunk.stairsRegions.end(), [&](auto region) { return isRegionVisible(region); });
+    };
+
+    visibleChunks.clear();
+    auto nonEmpty = size_t(0);
+    for (auto& chunk : chunks) {
+        if (chunk.blockRanges.empty() && chunk.stairsRegions.empty()) {
+            continue;
+        }
+
+        ++nonEmpty;
+        if (frustum.IntersectsBox(chunk.min, chunk.max) && hasVisibleRegion(chunk)) {
+            visibleChunks.push_back(&chunk);
+        }
+    }
+    stats.chunksDrawn = visibleChunks.size();
+    stats.chunksCulled = nonEmpty - visibleChunks.size();
+
+    // coarse voxels can close narrow corridors, so inside of the level only full detail is used (portal culling limits the geometry there)
+    auto cameraPosition = glm::vec3(glm::inverse(Assets::Get().view)[3]);
+    for (auto* chunk : visibleChunks) {
+        auto distance = glm::length(glm::clamp(cameraPosition, chunk->min, chunk->max) - cameraPosition);
+        chunk->lod = cameraOutside ? selectLOD(chunk->lod, distance) : 0;
+    }
+
+    blocksFirsts.clear();
+    blocksCounts.clear();
+    visibleStairs.clear();
+    stats.chunksCoarse = 0;
+    stats.blockTriangles = 0;
+    for (const auto* chunk : visibleChunks) {
+        if (chunk->lod != 0) {
+            // coarse blocks are not split by regions, the chunk has a visible region
+            ++stats.chunksCoarse;
+            auto count = chunk->coarseCounts[chunk->lod - 1];
+            if (count != 0) {
+                blocksFirsts.push_back(static_cast<GLint>(chunk->blocksFirst + chunk->coarseFirsts[chunk->lod - 1]));
+                blocksCounts.push_back(static_cast<GLsizei>(count));
+            }
+        } else {
+            // adjacent ranges of visible regions are drawn together
+            const auto& ranges = chunk->blockRanges;
+            for (size_t i = 0; i < ranges.size();) {
+                if (!isRegionVisible(ranges[i].region)) {
+                    ++i;
+                    continue;
+                }
+
+                auto first = chunk->blocksFirst + ranges[i].first;
+                auto count = ranges[i].count;
+                for (++i; i < ranges.size() && isRegionVisible(ranges[i].region); ++i) {
+                    count += ranges[i].count;
+                }
+                blocksFirsts.push_back(static_cast<GLint>(first));
+                blocksCounts.push_back(static_cast<GLsizei>(count));
+            }
+        }
+
+        if (std::any_of(chunk->stairsRegions.begin(), chunk->stairsRegions.end(), [&](auto region) { return isRegionVisible(region); })) {
+            visibleStairs.insert(visibleStairs.end(), chunk->stairs.begin(), chunk->stairs.end());
+        }
+    }
+
+    for (auto count : blocksCounts) {
+        stats.blockTriangles += static_cast<size_t>(count) / 3;
+    }
+
+    if (!blocksFirsts.empty()) {
+        InitRendering(meshShader);
+        BindModel(blocks);
+        glMultiDrawArrays(GL_TRIANGLES, blocksFirsts.data(), blocksCounts.data(), static_cast<GLsizei>(blocksFirsts.size()));
+    }
+
+    stairs.cnt = visibleStairs.size();
+    if (stairs.cnt != 0) {
+        // buffer is orphaned, so that the upload does not wait for the previous frame
+        glBindBuffer(GL_ARRAY_BUFFER, stairs.buf);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(stairs.cnt * sizeof(TileInstance)), visibleStairs.data(), GL_STREAM_DRAW);
 
-    if (cubeInstancedModel.cnt != 0) {
-        BindModel(cubeModel);
-        glDrawArraysInstanced(GL_TRIANGLES, 0, cubeModel.triangleCount * 3, static_cast<GLsizei>(cubeInstancedModel.cnt));
+        InitRendering(shader);
+        glBindVertexArray(stairs.vao);
+        glDrawElementsInstanced(GL_TRIANGLES, stairsModel.triangleCount * 3, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(stairs.cnt));
     }
-    for (size_t i = 0; i < 4; ++i) {
-        if (stairsInstancedModel[i].cnt != 0) {
-            BindModel(stairsModel[i]);
-            glDrawArraysInstanced(GL_TRIANGLES, 0, stairsModel[i].triangleCount * 3, static_cast<GLsizei>(stairsInstancedModel[i].cnt));
+}
+
+const TileRenderStats& TileRenderer::GetStats() const {
+    return stats;
+}
+
+void TileRenderer::uploadBlocks(Chunk& chunk, const ChunkRenderData& data) {
+    auto upload = [&](const std::vector<MeshVertex>& vertices, size_t first) {
+        if (!vertices.empty()) {
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>((chunk.blocksFirst + first) * sizeof(MeshVertex)),
+                            static_cast<GLsizeiptr>(vertices.size() * sizeof(MeshVertex)), vertices.data());
         }
+    };
+
+    upload(data.blocks, 0);
+    chunk.blockRanges = data.blockRanges;
+
+    auto first = data.blocks.size();
+    for (size_t i = 0; i < data.coarseBlocks.size(); ++i) {
+        upload(data.coarseBlocks[i], first);
+        chunk.coarseFirsts[i] = first;
+        chunk.coarseCounts[i] = data.coarseBlocks[i].size();
+        first += data.coarseBlocks[i].size();
     }
 }
 
-void TileRenderer::InitRendering() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);
+void TileRenderer::growBlocks(size_t capacity) {
+    VBO vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(MeshVertex)), nullptr, GL_DYNAMIC_DRAW);
+    if (blocksEnd != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, blocks.vbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(blocksEnd * sizeof(MeshVertex)));
+    }
 
-    shader.use();
-    shader.setInt("texture1", 0);
+    glDeleteBuffers(1, &blocks.vbo);
+    blocks.vbo = vbo;
+    setMeshAttributes(blocks.vao, blocks.vbo);
+    blocksCapacity = capacity;
+}
 
-    shader.setMat4("projection", Assets::Get().projection);
-    shader.setMat4("view", Assets::Get().view);
+bool TileRenderer::isRegionVisible(RegionId region) const {
+    return region >= visibleRegions.size() || visibleRegions[region];
 }
 
-InstancedModel::InstancedModel(size_t cnt_, BufferId buf_) : cnt(cnt_), buf(buf_) {
+void TileRenderer::InitRendering(const Shader& usedShader) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture1);
+
+    usedShader.use();
+    usedShader.setInt("texture1", 0);
+
+    usedShader.setMat4("projection", Assets::Get().projection);
+    usedShader.setMat4("view", Assets::Get().view);
 }
 
 InstancedModel::~InstancedModel() {
-    if (cnt != 0) {
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
         glDeleteBuffers(1, &buf);
     }
 }
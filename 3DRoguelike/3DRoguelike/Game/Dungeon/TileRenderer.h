@@ -8,23 +8,21 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <array>
+#include <optional>
 #include <vector>
 
+#include "Portals.h"
 #include "Tile.h"
+#include "TileRenderData.h"
 #include "../Assets.h"
 #include "../Renderer.h"
 #include "../Utility/Vector3D.h"
 #include "../Texture.h"
 
-struct PositionColor {
-    glm::vec3 position;
-    glm::vec3 color;
-    float scale;
-};
-
+// instance buffer, and vertex array that combines it with the model
 class InstancedModel {
  public:
-    InstancedModel(size_t cnt_, BufferId buf_);
+    InstancedModel() = default;
     ~InstancedModel();
 
     InstancedModel(InstancedModel const&) = delete;
@@ -32,24 +30,91 @@ class InstancedModel {
 
     size_t cnt = 0;
     BufferId buf = 0;
+    VAO vao = 0;
+};
+
+// counters of the last rendered frame
+struct TileRenderStats {
+    size_t chunksDrawn = 0;
+    size_t chunksCulled = 0;
+    // drawn chunks whose blocks used a coarse level of detail
+    size_t chunksCoarse = 0;
+    // triangles of the drawn blocks
+    size_t blockTriangles = 0;
+    // regions reached through the portals (0 if portal culling was not used)
+    size_t regionsVisible = 0;
+    size_t regionCount = 0;
 };
 
+// Renders the world in two draw calls: blocks of all chunks are stored in one vertex buffer and drawn with glMultiDrawArrays,
+// stairs of the visible chunks are uploaded every frame into one instance buffer (orientation is an instance attribute).
 class TileRenderer {
  public:
     TileRenderer();
 
-    void InitInstancedRendering(const std::vector<PositionColor>& tiles, const std::array<std::vector<PositionColor>, 4>& stairs);
-    void RenderTilesInstanced();
+    void InitInstancedRendering(const TileRenderData& data);
+    // replaces render data of the chunk with the index in TileRenderData::chunks (after the tiles were edited),
+    // blocks of the chunk are updated in place, they are moved to the end of the vertex buffer only if they do not fit into their slot
+    void UpdateChunk(size_t index, const ChunkRenderData& data);
+    // portal graph of the level whose render data is used (see Dungeon::GetPortals)
+    void InitPortalCulling(std::vector<Portal> portals, size_t regionCount);
+    // renders chunks that intersect the view frustum (projection and view matrices are taken from Assets),
+    // if the region of the camera is given, only the regions that can be seen from it through the portals are rendered,
+    // if the camera is outside of the level (bounds including the border), distant chunks are rendered with coarse levels of detail
+    void RenderTilesInstanced(std::optional<RegionId> cameraRegion = std::nullopt, bool cameraOutside = true);
+
+    const TileRenderStats& GetStats() const;
 
  private:
-    void InitRendering();
+    struct Chunk {
+        // bounds of the rendered geometry
+        glm::vec3 min = glm::vec3();
+        glm::vec3 max = glm::vec3();
+        // slot of the chunk in the vertex buffer of the blocks (in vertices), ranges start at the beginning of the slot,
+        // coarse blocks follow the blocks
+        size_t blocksFirst = 0;
+        size_t blocksCapacity = 0;
+        std::vector<RegionRange> blockRanges;
+        std::array<size_t, lodScales.size()> coarseFirsts = {};
+        std::array<size_t, lodScales.size()> coarseCounts = {};
+        // 0 - full detail, otherwise coarse blocks with the index lod - 1
+        size_t lod = 0;
+        std::vector<TileInstance> stairs;
+        std::vector<RegionId> stairsRegions;
+    };
+
+    // writes blocks and coarse blocks into the slot of the chunk
+    void uploadBlocks(Chunk& chunk, const ChunkRenderData& data);
+    // reallocates the vertex buffer of the blocks, slots are copied on the GPU
+    void growBlocks(size_t capacity);
+    void InitRendering(const Shader& usedShader);
+    // regions out of the portal graph are always visible
+    bool isRegionVisible(RegionId region) const;
 
  private:
-    GLModel cubeModel;
-    InstancedModel cubeInstancedModel;
-    std::array<GLModel, 4> stairsModel;
-    std::array<InstancedModel, 4> stairsInstancedModel;
+    GLModel stairsModel;
+    // blocks of all chunks, triangle count is not used
+    GLModel blocks;
+    // size of the vertex buffer of the blocks and end of the last slot (in vertices)
+    size_t blocksCapacity;
+    size_t blocksEnd;
+    // stairs of the visible chunks
+    InstancedModel stairs;
+
+    // same order as TileRenderData::chunks
+    std::vector<Chunk> chunks;
+    // chunks that are drawn in the current frame
+    std::vector<Chunk*> visibleChunks;
+    // ranges of the blocks and stairs that are drawn in the current frame
+    std::vector<GLint> blocksFirsts;
+    std::vector<GLsizei> blocksCounts;
+    std::vector<TileInstance> visibleStairs;
+    PortalGraph portalGraph;
+    // regions visible in the current frame, empty if portal culling is not used
+    std::vector<bool> visibleRegions;
+    TileRenderStats stats;
 
     Shader shader;
+    Shader meshShader;
     Texture texture1 = Texture();
 };
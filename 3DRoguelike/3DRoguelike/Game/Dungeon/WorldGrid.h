@@ -1,6 +1,21 @@
 #pragma once
 
+#include <cstdint>
+
 #include "Tile.h"
 #include "../Utility/Vector3D.h"
 
-using TilesVec = Vector3D<Tile>;
+// memory layout of the world grid, can be selected with TILES_LAYOUT_BRICK or TILES_LAYOUT_MORTON compile definitions
+#if defined(TILES_LAYOUT_MORTON)
+using TilesLayout = MortonLayout;
+#elif defined(TILES_LAYOUT_BRICK)
+using TilesLayout = BrickLayout<4>;
+#else
+using TilesLayout = LinearLayout;
+#endif
+
+using TilesVec = Vector3D<Tile, TilesLayout>;
+
+// id of the room or corridor that contains a tile: 0 means no region, rooms have ids 1..roomCount, corridors follow them
+using RegionId = std::uint16_t;
+using RegionsVec = Vector3D<RegionId>;
@@ -0,0 +1,28 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4& projectionView) {
+    // rows of the matrix (glm matrices are column-major)
+    auto row = [&](int i) { return glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]); };
+
+    // left, right, bottom, top, near, far
+    for (int i = 0; i < 3; ++i) {
+        planes[2 * i] = row(3) + row(i);
+        planes[2 * i + 1] = row(3) - row(i);
+    }
+
+    for (auto& plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+    for (const auto& plane : planes) {
+        // corner of the box that is the farthest along the normal
+        auto corner = glm::vec3(plane.x > 0.0f ? max.x : min.x, plane.y > 0.0f ? max.y : min.y, plane.z > 0.0f ? max.z : min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+// View frustum, planes are extracted from the projection * view matrix.
+class Frustum {
+ public:
+    explicit Frustum(const glm::mat4& projectionView);
+
+    // false if the axis-aligned box is outside of the frustum,
+    // true if it intersects it (boxes outside of the frustum near its edges can be reported as intersecting too)
+    bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+ private:
+    // (normal, distance), normals point inside the frustum
+    std::array<glm::vec4, 6> planes;
+};
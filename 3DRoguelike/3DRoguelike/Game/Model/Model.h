@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -14,6 +15,12 @@ using Face = std::array<Vertex, 3>;
 
 using ModelData = std::vector<Face>;
 
+// vertices shared by the faces, every three indices form a face
+struct IndexedModelData {
+    std::vector<Vertex> vertices;
+    std::vector<std::uint16_t> indices;
+};
+
 void Move(ModelData& faces, glm::vec3 offset);
 void RotateY(ModelData& faces);
 void RotateX(ModelData& faces);
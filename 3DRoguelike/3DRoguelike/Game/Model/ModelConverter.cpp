@@ -1,5 +1,11 @@
 #include "ModelConverter.h"
 
+#include <array>
+#include <limits>
+#include <map>
+
+#include "../Assert.h"
+
 ModelData OBJToModel(const OBJ::ModelData& data) {
     auto res = ModelData();
 
@@ -16,3 +22,23 @@ ModelData OBJToModel(const OBJ::ModelData& data) {
 
     return res;
 }
+
+IndexedModelData IndexModel(const ModelData& data) {
+    auto res = IndexedModelData();
+    // vertices are compared exactly, corners of the faces that share an OBJ vertex are equal
+    auto indices = std::map<std::array<float, 5>, std::uint16_t>();
+
+    for (const auto& face : data) {
+        for (const auto& vertex : face) {
+            auto key = std::array{vertex.position.x, vertex.position.y, vertex.position.z, vertex.texCoords.x, vertex.texCoords.y};
+            auto [it, inserted] = indices.try_emplace(key, static_cast<std::uint16_t>(res.vertices.size()));
+            if (inserted) {
+                LOG_ASSERT(res.vertices.size() <= std::numeric_limits<std::uint16_t>::max());
+                res.vertices.push_back(vertex);
+            }
+            res.indices.push_back(it->second);
+        }
+    }
+
+    return res;
+}
@@ -4,3 +4,5 @@
 #include "OBJModel.h"
 
 ModelData OBJToModel(const OBJ::ModelData& data);
+// merges equal vertices of the faces, faces keep their order
+IndexedModelData IndexModel(const ModelData& data);
@@ -6,19 +6,29 @@
 #include <glm/glm.hpp>
 
 #include "Assets.h"
+#include "Model/ModelConverter.h"
 
 GLModel SendModelDataToGPU(const ModelData& data) {
+    // shared vertices are transformed once (post-transform cache)
+    auto indexed = IndexModel(data);
+
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
     VBO vbo;
+    EBO ebo;
     VAO vao;
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
 
     glBindVertexArray(vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Face) * data.size(), &data[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * indexed.vertices.size(), indexed.vertices.data(), GL_STATIC_DRAW);
+
+    // element buffer binding is stored in the vertex array
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint16_t) * indexed.indices.size(), indexed.indices.data(), GL_STATIC_DRAW);
 
     // position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -27,7 +37,9 @@ GLModel SendModelDataToGPU(const ModelData& data) {
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    return {vao, vbo, static_cast<unsigned int>(data.size())};
+    glBindVertexArray(0);
+
+    return {vao, vbo, ebo, static_cast<unsigned int>(data.size())};
 }
 
 GLModel GetCubeModel() {
@@ -45,13 +57,21 @@ void BindModel(const GLModel& model) {
 }
 
 void RenderModel(const GLModel& model) {
-    glDrawArrays(GL_TRIANGLES, 0, model.triangleCount * 3);
+    if (model.ebo != 0) {
+        glDrawElements(GL_TRIANGLES, model.triangleCount * 3, GL_UNSIGNED_SHORT, nullptr);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, model.triangleCount * 3);
+    }
 }
 
 GLModel::GLModel(VAO vao_, VBO vbo_, unsigned int tc) : vao(vao_), vbo(vbo_), triangleCount(tc) {
 }
 
+GLModel::GLModel(VAO vao_, VBO vbo_, EBO ebo_, unsigned int tc) : vao(vao_), vbo(vbo_), ebo(ebo_), triangleCount(tc) {
+}
+
 GLModel::~GLModel() {
     glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
 }
@@ -4,11 +4,14 @@
 
 using VAO = unsigned int;
 using VBO = unsigned int;
+using EBO = unsigned int;
 using BufferId = unsigned int;
 
 class GLModel {
  public:
     GLModel(VAO vao_, VBO vbo_, unsigned int tc);
+    // indexed model, indices are 16-bit
+    GLModel(VAO vao_, VBO vbo_, EBO ebo_, unsigned int tc);
     ~GLModel();
 
     GLModel(GLModel const&) = delete;
@@ -16,6 +19,8 @@ class GLModel {
 
     VAO vao = 0;
     VBO vbo = 0;
+    // 0 if the vertices are not indexed
+    EBO ebo = 0;
     unsigned int triangleCount = 0;
 };
 
@@ -1,9 +0,0 @@
-#pragma once
-
-#include <string>
-
-namespace util {
-
-bool FilesAreEqual(const std::string& filename1, const std::string& filename2);
-
-}
@@ -12,7 +12,7 @@ namespace HAMT {
 template <typename Index>
 class INode {
  public:
-    using INodeT = typename INode<Index>;
+    using INodeT = INode<Index>;
 
  public:
     INode() = default;
@@ -35,7 +35,7 @@ class INode {
 template <typename Index, typename Bitmask, std::uint8_t ChildrenCount>
 class BranchNode : public INode<Index> {
  public:
-    using INodeT = typename INode<Index>;
+    using INodeT = INode<Index>;
 
  public:
     BranchNode() = default;
@@ -101,7 +101,7 @@ class BranchNode : public INode<Index> {
 template <typename Index>
 class LeafNode : public INode<Index> {
  public:
-    using INodeT = typename INode<Index>;
+    using INodeT = INode<Index>;
 
  public:
     LeafNode() = default;
@@ -126,12 +126,12 @@ class LeafNode : public INode<Index> {
 template <typename Key, typename Index, typename Bitmask, int Depth, int IndexBitsCount>
 class Set {
  public:
-    using INodeT = typename INode<Index>;
+    using INodeT = INode<Index>;
 
     template <std::uint8_t ChildrenCount>
     using BranchNodeT = BranchNode<Index, Bitmask, ChildrenCount>;
 
-    using LeafNodeT = typename LeafNode<Index>;
+    using LeafNodeT = LeafNode<Index>;
 
  public:
     Set() = default;
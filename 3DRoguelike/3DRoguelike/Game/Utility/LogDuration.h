@@ -33,7 +33,9 @@ class LogDuration {
 #define UNIQ_ID(lineno) UNIQ_ID_IMPL(lineno)
 #endif
 
+#ifndef NO_LOG_DURATION
 #define LOG
+#endif
 #ifdef LOG
 #define LOG_DURATION(message) \
     LogDuration UNIQ_ID(__LINE__) { message }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace util {
+
+// Read-only memory mapped file (mmap on POSIX, file mapping on Windows).
+class MappedFile {
+ public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // returns false if file does not exist, is empty or can not be mapped
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const;
+    std::span<const std::byte> GetData() const;
+
+ private:
+    const std::byte* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+}  // namespace util
@@ -1,5 +1,6 @@
 #include "MeasureStatistics.h"
 
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 
@@ -28,14 +29,14 @@ void printTime(const std::string& name, Time total, Time min, Time max) {
 
 }  // namespace
 
-#define PRINT_COUNT(name) printCount(#name, s.##name##Count)
-#define PRINT_TIME_WITH_TYPE(name, type) printTime(std::string(#name) + " " + #type, s.##name##type##Time)
-#define PRINT_TIME(name) printTime(#name, s.##name##TotalTime, s.##name##MinTime, s.##name##MaxTime)
+#define PRINT_COUNT(name) printCount(#name, s.name##Count)
+#define PRINT_TIME_WITH_TYPE(name, type) printTime(std::string(#name) + " " + #type, s.name##type##Time)
+#define PRINT_TIME(name) printTime(#name, s.name##TotalTime, s.name##MinTime, s.name##MaxTime)
 
 namespace util {
 
 Statistics& GetStatistics() {
-    static Statistics s;
+    thread_local Statistics s;
     return s;
 }
 
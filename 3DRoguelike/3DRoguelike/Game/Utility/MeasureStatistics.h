@@ -25,11 +25,11 @@ static constexpr Time minTime = std::numeric_limits<Time>::min();
     Time stat##TotalTime = 0;     \
     Time stat##MinTime = maxTime; \
     Time stat##MaxTime = minTime
-#define CLEAR_STAT(name)         \
-    s.##name##Count = 0;         \
-    s.##name##TotalTime = 0;     \
-    s.##name##MinTime = maxTime; \
-    s.##name##MaxTime = minTime
+#define CLEAR_STAT(name)       \
+    s.name##Count = 0;         \
+    s.name##TotalTime = 0;     \
+    s.name##MinTime = maxTime; \
+    s.name##MaxTime = minTime
 
 // Statistics struct
 
@@ -53,6 +53,7 @@ struct Statistics {
     int all = 0;
 };
 
+// statistics are gathered separately for every thread
 Statistics& GetStatistics();
 void PrintReport();
 void Reset();
@@ -94,7 +95,7 @@ class MeasureDuration {
 
 #define MEASURE_STAT(stat)            \
     auto& _s = util::GetStatistics(); \
-    MEASURE_DURATION(_s.##stat##TotalTime, _s.##stat##MinTime, _s.##stat##MaxTime, _s.##stat##Count)
+    MEASURE_DURATION(_s.stat##TotalTime, _s.stat##MinTime, _s.stat##MaxTime, _s.stat##Count)
 
 // Meassure Set Statistics
 
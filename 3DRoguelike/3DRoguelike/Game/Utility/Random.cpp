@@ -1,5 +1,49 @@
 #include "Random.h"
 
+std::uint64_t CounterEngine::Mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+RNG::RNG(KeyTag, std::uint64_t key_, RNGMode mode) : key(key_), engine(makeEngine(key_, mode)) {
+}
+
+RNG::Engine RNG::makeEngine(std::uint64_t key, RNGMode mode) {
+    if (mode == RNGMode::Counter) {
+        return CounterEngine(key);
+    }
+
+    auto seq = std::seed_seq{static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32)};
+    return std::mt19937(seq);
+}
+
+RNGMode RNG::GetMode() const {
+    return std::holds_alternative<CounterEngine>(engine) ? RNGMode::Counter : RNGMode::MersenneTwister;
+}
+
+RNG RNG::Substream(std::uint64_t purpose, std::uint64_t index) const {
+    auto subkey = CounterEngine::Mix(CounterEngine::Mix(key + purpose * CounterEngine::golden) + index * 0xD1B54A32D192ED03ull);
+    return RNG(KeyTag(), subkey, GetMode());
+}
+
+std::uint64_t RNG::counterUniform(std::uint64_t range) {
+    auto& counter = std::get<CounterEngine>(engine);
+    if (range == std::numeric_limits<std::uint64_t>::max()) {
+        return counter();
+    }
+
+    // rejection sampling, so that the result is not biased
+    auto n = range + 1;
+    auto threshold = (0 - n) % n;
+    while (true) {
+        auto value = counter();
+        if (value >= threshold) {
+            return value % n;
+        }
+    }
+}
+
 bool RNG::RandomBool(float chance) {
     return RealUniform(0.0f, 1.0f) < chance;
 }
@@ -9,5 +53,6 @@ glm::ivec3 RNG::RandomIVec3(glm::ivec3 a, glm::ivec3 b) {
 }
 
 SeedType RNG::RandomSeed() {
+    thread_local auto rd = std::random_device();
     return SeedType(rd());
 }
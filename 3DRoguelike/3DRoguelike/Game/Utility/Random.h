@@ -1,34 +1,104 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <random>
+#include <type_traits>
+#include <variant>
 
 #include <glm/glm.hpp>
 
 using SeedType = unsigned int;
 
+// Counter-based generator (SplitMix64 finalizer applied to key + counter).
+// It has only 16 bytes of state, so creating and reseeding streams is free.
+class CounterEngine {
+ public:
+    using result_type = std::uint64_t;
+
+    explicit CounterEngine(std::uint64_t key_ = 0) : key(key_), counter(0) {
+    }
+
+    static constexpr result_type min() {
+        return std::numeric_limits<result_type>::min();
+    }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        return Mix(key + ++counter * golden);
+    }
+
+    static std::uint64_t Mix(std::uint64_t z);
+
+    static constexpr std::uint64_t golden = 0x9E3779B97F4A7C15ull;
+
+ private:
+    std::uint64_t key;
+    std::uint64_t counter;
+};
+
+// MersenneTwister - legacy mode, canon files were generated with it
+// Counter - independent substreams, results do not depend on the standard library implementation
+enum class RNGMode { MersenneTwister, Counter };
+
 class RNG {
  public:
     template <typename T>
-    RNG(const T& seed) : rng(seed), rd() {
+    RNG(const T& seed, RNGMode mode = RNGMode::MersenneTwister)
+        : key(CounterEngine::Mix(static_cast<std::uint64_t>(seed))),
+          engine(mode == RNGMode::Counter ? Engine(CounterEngine(key)) : Engine(std::mt19937(seed))) {
     }
     template <typename T>
     void Seed(const T& seed) {
-        rng.seed(seed);
+        key = CounterEngine::Mix(static_cast<std::uint64_t>(seed));
+        if (auto mt = std::get_if<std::mt19937>(&engine)) {
+            mt->seed(seed);
+        } else {
+            engine = CounterEngine(key);
+        }
     }
 
+    RNGMode GetMode() const;
+
+    // Independent stream, determined only by the last seed, purpose and index (and not by the numbers drawn so far).
+    RNG Substream(std::uint64_t purpose, std::uint64_t index = 0) const;
+
     template <typename T>
     T IntUniform(T a, T b) {
-        return std::uniform_int_distribution<T>(a, b)(rng);
+        if (auto mt = std::get_if<std::mt19937>(&engine)) {
+            return std::uniform_int_distribution<T>(a, b)(*mt);
+        }
+
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) + static_cast<U>(counterUniform(static_cast<U>(static_cast<U>(b) - static_cast<U>(a)))));
     }
     template <typename T>
     T RealUniform(T a, T b) {
-        return std::uniform_real_distribution<T>(a, b)(rng);
+        if (auto mt = std::get_if<std::mt19937>(&engine)) {
+            return std::uniform_real_distribution<T>(a, b)(*mt);
+        }
+
+        // uniform number in [0, 1), precision of the mantissa
+        auto bits = std::get<CounterEngine>(engine)();
+        auto unit = sizeof(T) <= sizeof(float) ? static_cast<T>(bits >> 40) * static_cast<T>(0x1.0p-24)
+                                               : static_cast<T>(bits >> 11) * static_cast<T>(0x1.0p-53);
+        return a + (b - a) * unit;
     }
 
     template <typename Iter>
     void Shuffle(Iter begin, Iter end) {
-        std::shuffle(begin, end, rng);
+        if (auto mt = std::get_if<std::mt19937>(&engine)) {
+            std::shuffle(begin, end, *mt);
+            return;
+        }
+
+        // Fisher-Yates, std::shuffle is implementation defined
+        for (auto i = static_cast<std::uint64_t>(end - begin); i > 1; --i) {
+            std::iter_swap(begin + (i - 1), begin + counterUniform(i - 1));
+        }
     }
 
     bool RandomBool(float chance = 0.5f);
@@ -38,6 +108,16 @@ class RNG {
     SeedType RandomSeed();
 
  private:
-    std::mt19937 rng;
-    std::random_device rd;
+    using Engine = std::variant<std::mt19937, CounterEngine>;
+
+    struct KeyTag {};
+    RNG(KeyTag, std::uint64_t key_, RNGMode mode);
+    static Engine makeEngine(std::uint64_t key, RNGMode mode);
+
+    // uniform number in [0, range]
+    std::uint64_t counterUniform(std::uint64_t range);
+
+ private:
+    std::uint64_t key;
+    Engine engine;
 };
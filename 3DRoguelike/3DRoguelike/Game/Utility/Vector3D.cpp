@@ -1,5 +1,7 @@
 #include "Vector3D.h"
 
+#include <cstdint>
+
 #include "../Assert.h"
 
 glm::ivec3 AsIVec3(const Dimensions& dimensions) {
@@ -102,3 +104,46 @@ size_t Volume(const Dimensions& dimensions) {
 size_t CoordinatesToIndex(const glm::ivec3& coordinates, const Dimensions& dimensions) {
     return coordinates.x * dimensions.length * dimensions.height + coordinates.y * dimensions.length + coordinates.z;
 }
+
+// memory layouts
+
+size_t LinearLayout::StorageSize(const Dimensions& dimensions) {
+    return Volume(dimensions);
+}
+
+size_t LinearLayout::Index(const glm::ivec3& coordinates, const Dimensions& dimensions) {
+    return CoordinatesToIndex(coordinates, dimensions);
+}
+
+size_t LinearLayout::RowRun(const glm::ivec3& coordinates, const Dimensions& dimensions) {
+    return dimensions.length - static_cast<size_t>(coordinates.z);
+}
+
+// spreads lower 21 bits of value, so that there are two zero bits between each pair of bits
+std::uint64_t spreadBits(std::uint64_t value) {
+    value &= 0x1fffff;
+    value = (value | value << 32) & 0x1f00000000ffff;
+    value = (value | value << 16) & 0x1f0000ff0000ff;
+    value = (value | value << 8) & 0x100f00f00f00f00f;
+    value = (value | value << 4) & 0x10c30c30c30c30c3;
+    value = (value | value << 2) & 0x1249249249249249;
+    return value;
+}
+
+size_t MortonLayout::StorageSize(const Dimensions& dimensions) {
+    if (Volume(dimensions) == 0) {
+        return 0;
+    }
+
+    // Morton index grows monotonically along every axis, so the last element has the largest index
+    return Index(AsIVec3(dimensions) - 1, dimensions) + 1;
+}
+
+size_t MortonLayout::Index(const glm::ivec3& coordinates, const Dimensions& dimensions) {
+    return static_cast<size_t>(spreadBits(coordinates.x) << 2 | spreadBits(coordinates.y) << 1 | spreadBits(coordinates.z));
+}
+
+size_t MortonLayout::RowRun(const glm::ivec3& coordinates, const Dimensions& dimensions) {
+    // z is the lowest interleaved bit, so only pairs of elements (even z, odd z) are adjacent
+    return 2 - static_cast<size_t>(coordinates.z & 1);
+}
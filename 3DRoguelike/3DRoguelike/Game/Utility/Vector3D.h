@@ -1,7 +1,7 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -9,6 +9,7 @@
 #include <glm/gtx/std_based_type.hpp>
 
 #include "../Dungeon/Tile.h"
+#include "../Assert.h"
 
 struct Dimensions {
     size_t width = 0;
@@ -59,77 +60,168 @@ size_t CoordinatesToIndex(const glm::ivec3& coordinates, const Dimensions& dimen
 
 bool operator<(const glm::ivec3& a, const glm::ivec3& b);
 
+// memory layouts for Vector3D
+// layout maps in-bounds coordinates to an index in the underlying storage
+
+// x-major linear indexing, z is contiguous in memory
+struct LinearLayout {
+    static constexpr auto name = "linear";
+
+    static size_t StorageSize(const Dimensions& dimensions);
+    static size_t Index(const glm::ivec3& coordinates, const Dimensions& dimensions);
+    // number of elements along z starting at coordinates that are stored contiguously
+    static size_t RowRun(const glm::ivec3& coordinates, const Dimensions& dimensions);
+};
+
+// grid is split into Size^3 bricks, bricks are stored in x-major order, and so are elements inside of each brick
+template <size_t Size>
+struct BrickLayout {
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "brick size must be a power of two");
+
+    static constexpr auto name = "brick";
+
+    static size_t StorageSize(const Dimensions& dimensions) {
+        return bricks(dimensions.width) * bricks(dimensions.height) * bricks(dimensions.length) * brickVolume;
+    }
+    static size_t Index(const glm::ivec3& coordinates, const Dimensions& dimensions) {
+        auto x = static_cast<size_t>(coordinates.x);
+        auto y = static_cast<size_t>(coordinates.y);
+        auto z = static_cast<size_t>(coordinates.z);
+
+        auto brickIndex = ((x / Size) * bricks(dimensions.height) + y / Size) * bricks(dimensions.length) + z / Size;
+        return brickIndex * brickVolume + ((x % Size) * Size + y % Size) * Size + z % Size;
+    }
+    static size_t RowRun(const glm::ivec3& coordinates, const Dimensions& dimensions) {
+        return Size - static_cast<size_t>(coordinates.z) % Size;
+    }
+
+ private:
+    static constexpr size_t brickVolume = Size * Size * Size;
+
+    static size_t bricks(size_t size) {
+        return (size + Size - 1) / Size;
+    }
+};
+
+// Morton (Z-order) curve, bits of x, y and z coordinates are interleaved
+struct MortonLayout {
+    static constexpr auto name = "morton";
+
+    static size_t StorageSize(const Dimensions& dimensions);
+    static size_t Index(const glm::ivec3& coordinates, const Dimensions& dimensions);
+    static size_t RowRun(const glm::ivec3& coordinates, const Dimensions& dimensions);
+};
+
 // Vector3D class
 
-template <typename T>
+// elements outside of the grid are stored in the border (halo) of configurable width around it
+template <typename T, typename Layout = LinearLayout>
 class Vector3D {
  public:
-    Vector3D(const Dimensions& dimensions_ = Dimensions(), const T& init = T())
-        : dimensions(dimensions_), data(Volume(dimensions), init), outOfBounds() {
+    Vector3D(const Dimensions& dimensions_ = Dimensions(), const T& init = T(), size_t border_ = 0)
+        : dimensions(dimensions_),
+          border(border_),
+          storageDimensions(FromIVec3(AsIVec3(dimensions) + 2 * static_cast<int>(border))),
+          data(Layout::StorageSize(storageDimensions), init) {
     }
 
     void Set(const glm::ivec3& coordinates, const T& elem) {
-        data[CoordinatesToIndex(coordinates, dimensions)] = elem;
+        data[index(coordinates)] = elem;
     }
     void Set(size_t x, size_t y, size_t z, const T& elem) {
         Set(glm::ivec3{x, y, z}, elem);
     }
 
     const T& Get(const glm::ivec3& coordinates) const {
-        return data[CoordinatesToIndex(coordinates, dimensions)];
+        return data[index(coordinates)];
     }
     const T& Get(size_t x, size_t y, size_t z) const {
         return Get(glm::ivec3{x, y, z});
     }
 
     T& Get(const glm::ivec3& coordinates) {
-        return data[CoordinatesToIndex(coordinates, dimensions)];
+        return data[index(coordinates)];
     }
     T& Get(size_t x, size_t y, size_t z) {
         return Get(glm::ivec3{x, y, z});
     }
 
+    // sets count elements along z starting at coordinates, contiguous parts of the storage are filled at once
+    void FillRow(const glm::ivec3& coordinates, size_t count, const T& elem) {
+        auto coords = coordinates + static_cast<int>(border);
+        while (count > 0) {
+            auto run = std::min(count, Layout::RowRun(coords, storageDimensions));
+            auto first = data.begin() + Layout::Index(coords, storageDimensions);
+            std::fill(first, first + run, elem);
+
+            coords.z += static_cast<int>(run);
+            count -= run;
+        }
+    }
+
     T GetValue(const glm::ivec3& coordinates) const {
-        return data[CoordinatesToIndex(coordinates, dimensions)];
+        return data[index(coordinates)];
     }
 
     const Dimensions& GetDimensions() const {
         return dimensions;
     }
 
+    size_t GetBorder() const {
+        return border;
+    }
+
+    bool IsInBoundsOrBorder(const glm::ivec3& coords) const {
+        return IsInBounds(coords + static_cast<int>(border), storageDimensions);
+    }
+
+    // coords can be either in bounds, or in the border
     void SetInOrOutOfBounds(const glm::ivec3& coords, const T& elem) {
-        if (IsInBounds(coords, dimensions)) {
-            Set(coords, elem);
-        } else {
-            outOfBounds[coords] = elem;
-        }
+        LOG_ASSERT(IsInBoundsOrBorder(coords));
+        Set(coords, elem);
     }
+    // elements that are not in bounds and not in the border are default constructed
     T GetInOrOutOfBounds(const glm::ivec3& coords) const {
-        if (IsInBounds(coords, dimensions)) {
+        if (IsInBoundsOrBorder(coords)) {
             return GetValue(coords);
         } else {
-            if (outOfBounds.contains(coords)) {
-                return outOfBounds.at(coords);
-            } else {
-                return T();
-            }
+            return T();
         }
     }
-    const std::unordered_map<glm::ivec3, T> GetOutOfBoundsMap() const {
-        return outOfBounds;
-    }
 
-    auto begin() const {
-        return data.begin();
+    // calls func(coords, elem) for every element in the border, does not allocate memory
+    template <typename Func>
+    void ForEachBorderElement(Func&& func) const {
+        auto b = static_cast<int>(border);
+        auto size = AsIVec3(dimensions);
+
+        for (int x = -b; x < size.x + b; ++x) {
+            for (int y = -b; y < size.y + b; ++y) {
+                auto rowInBounds = x >= 0 && x < size.x && y >= 0 && y < size.y;
+                for (int z = -b; z < size.z + b; ++z) {
+                    // skip elements that are in bounds
+                    if (rowInBounds && z == 0) {
+                        z = size.z - 1;
+                        continue;
+                    }
+
+                    auto coords = glm::ivec3(x, y, z);
+                    func(coords, Get(coords));
+                }
+            }
+        }
     }
 
-    auto end() const {
-        return data.end();
+ private:
+    size_t index(const glm::ivec3& coordinates) const {
+        return Layout::Index(coordinates + static_cast<int>(border), storageDimensions);
     }
 
  private:
     Dimensions dimensions;
-    std::vector<T> data;
+    size_t border;
 
-    std::unordered_map<glm::ivec3, T> outOfBounds;
+    // dimensions including the border
+    Dimensions storageDimensions;
+    std::vector<T> data;
 };
@@ -3,7 +3,7 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 instanceOffset;
 layout (location = 3) in vec3 instanceColor;
-layout (location = 4) in float instanceScale;
+layout (location = 4) in int instanceOrientation;
 
 out vec2 TexCoord;
 out vec3 Color;
@@ -13,7 +13,13 @@ uniform mat4 projection;
 
 void main()
 {
-	gl_Position = projection * view * vec4(instanceScale * aPos + instanceOffset, 1.0f);
+	// quarter turns around the y axis, same as RotateY
+	vec3 position = aPos;
+	for (int i = 0; i < instanceOrientation; ++i) {
+		position = vec3(-position.z, position.y, position.x);
+	}
+
+	gl_Position = projection * view * vec4(position + instanceOffset, 1.0f);
 	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
 	Color = instanceColor;
 }
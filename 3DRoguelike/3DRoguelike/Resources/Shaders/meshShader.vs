@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in int aAxis;
+layout (location = 2) in vec3 aColor;
+
+out vec2 TexCoord;
+out vec3 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	// positions are stored doubled, corners of the tiles are at half-integer coordinates
+	vec3 position = 0.5f * aPos;
+	gl_Position = projection * view * vec4(position, 1.0f);
+
+	// texture coordinates of the cube model (cube.obj) in world space, so that merged faces repeat the texture once per tile
+	if (aAxis == 0) {
+		TexCoord = vec2(0.5f - position.z, position.y + 0.5f);
+	} else if (aAxis == 1) {
+		TexCoord = vec2(position.x + 0.5f, 0.5f - position.z);
+	} else {
+		TexCoord = vec2(position.x + 0.5f, position.y + 0.5f);
+	}
+	Color = aColor;
+}
@@ -0,0 +1,206 @@
+// Headless batch dungeon generator.
+// Generates levels for a range of seeds on all cores (one Dungeon per worker thread),
+// writes serialized levels and per-seed statistics (stats.csv) to the output directory.
+//
+// Usage: dungeon_gen <first seed> <last seed> [--size <width> <height> <length>] [--rooms <count>] [--threads <count>] [--out <directory>]
+//                    [--rng mt|counter] [--placement rejection|free-space] [--format binary|text]
+// Seeds are generated in range [first seed, last seed).
+// Levels are written in binary format (<seed>.lvl, see DungeonFormat.h) by default, or in text format (<seed>.txt) used by canon files.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Game/Dungeon/Dungeon.h"
+#include "../Game/Utility/MeasureStatistics.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    SeedType firstSeed = 0;
+    SeedType lastSeed = 0;
+    Dimensions dimensions = Dimensions{50, 20, 50};
+    size_t rooms = 10;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::filesystem::path out = "levels";
+    RNGMode rngMode = RNGMode::MersenneTwister;
+    RoomPlacement roomPlacement = RoomPlacement::Rejection;
+    bool binary = true;
+};
+
+struct LevelStats {
+    SeedType seed = 0;
+    size_t rooms = 0;
+    size_t corridors = 0;
+    glm::ivec3 spawn = glm::ivec3();
+    // content hash (see CanonCheck.h), can be used to validate levels against the canon manifest
+    std::uint64_t hash = 0;
+
+    // all times are in microseconds
+    util::Time totalTime = 0;
+    util::Time roomsTime = 0;
+    util::Time corridorsTime = 0;
+    util::Count pathCount = 0;
+    util::Time pathsTime = 0;
+    util::Time serializeTime = 0;
+};
+
+void printUsage() {
+    std::cerr << "Usage: dungeon_gen <first seed> <last seed> [--size <width> <height> <length>] [--rooms <count>] [--threads <count>] "
+                 "[--out <directory>] [--rng mt|counter] [--placement rejection|free-space] [--format binary|text]\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    if (argc < 3) {
+        return false;
+    }
+
+    try {
+        options.firstSeed = static_cast<SeedType>(std::stoull(argv[1]));
+        options.lastSeed = static_cast<SeedType>(std::stoull(argv[2]));
+
+        for (int i = 3; i < argc; ++i) {
+            auto arg = std::string(argv[i]);
+            auto remaining = argc - i - 1;
+
+            if (arg == "--size" && remaining >= 3) {
+                options.dimensions.width = std::stoull(argv[++i]);
+                options.dimensions.height = std::stoull(argv[++i]);
+                options.dimensions.length = std::stoull(argv[++i]);
+            } else if (arg == "--rooms" && remaining >= 1) {
+                options.rooms = std::stoull(argv[++i]);
+            } else if (arg == "--threads" && remaining >= 1) {
+                options.threads = std::stoull(argv[++i]);
+            } else if (arg == "--out" && remaining >= 1) {
+                options.out = argv[++i];
+            } else if (arg == "--rng" && remaining >= 1) {
+                auto mode = std::string(argv[++i]);
+                if (mode != "mt" && mode != "counter") {
+                    return false;
+                }
+                options.rngMode = mode == "counter" ? RNGMode::Counter : RNGMode::MersenneTwister;
+            } else if (arg == "--placement" && remaining >= 1) {
+                auto placement = std::string(argv[++i]);
+                if (placement != "rejection" && placement != "free-space") {
+                    return false;
+                }
+                options.roomPlacement = placement == "free-space" ? RoomPlacement::FreeSpace : RoomPlacement::Rejection;
+            } else if (arg == "--format" && remaining >= 1) {
+                auto format = std::string(argv[++i]);
+                if (format != "binary" && format != "text") {
+                    return false;
+                }
+                options.binary = format == "binary";
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    // smaller levels do not fit even one room
+    auto roomFits = BoxFitsIntoBox(Box{glm::ivec3(), MinRoomSize()}, Box{glm::ivec3(), options.dimensions});
+    return options.firstSeed < options.lastSeed && options.rooms > 0 && options.threads > 0 && roomFits;
+}
+
+LevelStats generateLevel(Dungeon& dungeon, SeedType seed, const Options& options) {
+    util::Reset();
+
+    auto start = Clock::now();
+    dungeon.SetSeed(seed);
+    dungeon.Generate();
+    auto generated = Clock::now();
+    if (options.binary) {
+        dungeon.SerializeBinary((options.out / (std::to_string(seed) + ".lvl")).string());
+    } else {
+        dungeon.Serialize((options.out / (std::to_string(seed) + ".txt")).string());
+    }
+    auto serialized = Clock::now();
+
+    const auto& s = util::GetStatistics();
+
+    auto stats = LevelStats();
+    stats.seed = seed;
+    stats.rooms = dungeon.GetRoomCount();
+    stats.corridors = dungeon.GetCorridorCount();
+    stats.spawn = dungeon.GetSpawnPoint();
+    stats.hash = dungeon.ContentHash();
+    stats.totalTime = LogDuration::diff(start, generated);
+    stats.roomsTime = s.generateRoomsTotalTime;
+    stats.corridorsTime = s.generateCorridorsTotalTime;
+    stats.pathCount = s.findPathCount;
+    stats.pathsTime = s.findPathTotalTime;
+    stats.serializeTime = LogDuration::diff(generated, serialized);
+
+    return stats;
+}
+
+void writeStats(const std::filesystem::path& filename, const std::vector<LevelStats>& levels) {
+    auto file = std::ofstream(filename);
+
+    file << "seed,rooms,corridors,spawn_x,spawn_y,spawn_z,hash,total_us,rooms_us,corridors_us,paths,paths_us,serialize_us\n";
+    for (const auto& level : levels) {
+        file << level.seed << "," << level.rooms << "," << level.corridors << "," << level.spawn.x << "," << level.spawn.y << "," << level.spawn.z << ","
+             << std::hex << std::setw(16) << std::setfill('0') << level.hash << std::dec << "," << level.totalTime << "," << level.roomsTime << ","
+             << level.corridorsTime << "," << level.pathCount << "," << level.pathsTime << "," << level.serializeTime << "\n";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = Options();
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    std::filesystem::create_directories(options.out);
+
+    auto count = static_cast<size_t>(options.lastSeed - options.firstSeed);
+    auto threads = std::min(options.threads, count);
+    auto levels = std::vector<LevelStats>(count);
+
+    // seeds are distributed dynamically, because generation time differs a lot between seeds
+    auto next = std::atomic<size_t>(0);
+    auto worker = [&]() {
+        auto dungeon = Dungeon(options.dimensions);
+        dungeon.SetRNGMode(options.rngMode);
+        dungeon.SetRoomCount(options.rooms);
+        dungeon.SetRoomPlacement(options.roomPlacement);
+        dungeon.SetCanonCheck(CanonCheck::None);
+        dungeon.SetVerbose(false);
+
+        for (auto i = next++; i < count; i = next++) {
+            levels[i] = generateLevel(dungeon, options.firstSeed + static_cast<SeedType>(i), options);
+        }
+    };
+
+    auto start = Clock::now();
+
+    auto workers = std::vector<std::thread>();
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    writeStats(options.out / "stats.csv", levels);
+
+    std::cout << "Generated " << count << " levels on " << threads << " threads in " << seconds << " s (" << count / seconds << " levels/s)\n";
+
+    return 0;
+}